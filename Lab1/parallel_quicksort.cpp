@@ -1,11 +1,18 @@
 #include <algorithm>
 #include <chrono>
 #include <fstream>
+#include <functional>
 #include <future>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "../common/instrument.h"
+
 using namespace std;
 
 const int THRESHOLD = 10000;
@@ -55,12 +62,19 @@ void quicksortParallel(vector<int> &arr, int left, int right, int depth = 0) {
   if (left >= right)
     return;
 
+  // 打点只放在并行的各层 (最多约 2^11 个区间), 不放进 partition 本身:
+  // 单线程递归里它对每个小子数组都执行一次, 打点的开销会超过分区本身
   if (right - left < THRESHOLD || depth > 10) {
+    INSTRUMENT_SCOPE("quicksort.leafSort");
     quicksortSingle(arr, left, right);
     return;
   }
 
-  int pi = partition(arr, left, right);
+  int pi;
+  {
+    INSTRUMENT_SCOPE("quicksort.partition");
+    pi = partition(arr, left, right);
+  }
 
   auto leftFuture = async(launch::async, [&]() {
     quicksortParallel(arr, left, pi - 1, depth + 1);
@@ -71,6 +85,231 @@ void quicksortParallel(vector<int> &arr, int left, int right, int depth = 0) {
   leftFuture.wait();
 }
 
+// ==================== 选择: 第 k 小、分位数与 top-k ====================
+// 只需要中位数、分位数或最大的 k 个元素时不必完全排序:
+// 每次划分后只进入包含目标秩的一侧, 期望 O(n)。
+
+const int SELECT_SMALL = 16; // 小于该长度时直接插入排序
+
+void insertionSort(vector<int> &arr, int left, int right) {
+  for (int i = left + 1; i <= right; i++) {
+    int key = arr[i];
+    int j = i - 1;
+    while (j >= left && arr[j] > key) {
+      arr[j + 1] = arr[j];
+      j--;
+    }
+    arr[j + 1] = key;
+  }
+}
+
+// 聚集元素的三路划分: 以 pivot 为基准, 完成后
+// [left, lt) < pivot, [lt, gt] == pivot, (gt, right] > pivot。
+// partition 遇到大量重复元素时总把它们分到一侧, 选择会退化为 O(n^2);
+// 这里与基准相等的元素聚在中间, 目标秩落在其中即可结束
+void partitionThreeWay(vector<int> &arr, int left, int right, int pivot,
+                       int &lt, int &gt) {
+  lt = left;
+  gt = right;
+  int i = left;
+  while (i <= gt) {
+    if (arr[i] < pivot) {
+      swap(arr[lt++], arr[i++]);
+    } else if (arr[i] > pivot) {
+      swap(arr[i], arr[gt--]);
+    } else {
+      i++;
+    }
+  }
+}
+
+void selectRange(vector<int> &arr, int left, int right, int k,
+                 int badSplits);
+
+// 中位数的中位数 (BFPRT): 每 5 个一组取中位数, 放到区间开头, 再递归选出
+// 它们的中位数作为基准。至少 3/10 的元素落在基准两侧, 保证最坏 O(n)
+int medianOfMedians(vector<int> &arr, int left, int right) {
+  if (right - left < 5) {
+    insertionSort(arr, left, right);
+    return arr[left + (right - left) / 2];
+  }
+  int medians = left;
+  for (int i = left; i <= right; i += 5) {
+    int groupEnd = min(i + 4, right);
+    insertionSort(arr, i, groupEnd);
+    swap(arr[medians++], arr[i + (groupEnd - i) / 2]);
+  }
+  int mid = left + (medians - 1 - left) / 2;
+  selectRange(arr, left, medians - 1, mid, 0);
+  return arr[mid];
+}
+
+// 在 arr[left..right] 中选出第 k 小 (k 为数组下标)。
+// 先用三数取中 (与排序相同的基准); 保留下来的一侧超过区间 3/4 记为一次
+// 坏划分, 坏划分用完后改用中位数的中位数, 避免退化
+void selectRange(vector<int> &arr, int left, int right, int k,
+                 int badSplits) {
+  while (right - left >= SELECT_SMALL) {
+    int pivot = badSplits > 0 ? arr[medianOfThree(arr, left, right)]
+                              : medianOfMedians(arr, left, right);
+    int lt, gt;
+    partitionThreeWay(arr, left, right, pivot, lt, gt);
+    int size = right - left + 1;
+    if (k < lt) {
+      right = lt - 1;
+    } else if (k > gt) {
+      left = gt + 1;
+    } else {
+      return;
+    }
+    if (right - left + 1 > size / 4 * 3) {
+      badSplits--;
+    }
+  }
+  insertionSort(arr, left, right);
+}
+
+// 以 2 * log2(n) 次坏划分为限
+int badSplitBudget(int n) {
+  int budget = 0;
+  while (n > 1) {
+    n >>= 1;
+    budget += 2;
+  }
+  return budget;
+}
+
+// 快速选择: 完成后 arr[k] 为第 k 小, 左边都不大于它, 右边都不小于它
+// (与 std::nth_element 相同)
+void quickselect(vector<int> &arr, int k) {
+  INSTRUMENT_SCOPE("select.quickselect");
+  selectRange(arr, 0, arr.size() - 1, k, badSplitBudget(arr.size()));
+}
+
+// 一次划分同时服务多个秩: ranks[rLo..rHi] 升序, 都落在 [left, right] 内。
+// 划分后把秩分到两侧分别递归, 两侧都有秩且区间够大时像 quicksortParallel
+// 一样让左侧在另一个线程上进行。完成后每个 arr[ranks[i]] 都是第 ranks[i] 小
+void multiselect(vector<int> &arr, int left, int right,
+                 const vector<int> &ranks, int rLo, int rHi, int badSplits,
+                 int depth = 0) {
+  if (rLo > rHi) {
+    return;
+  }
+  if (rLo == rHi) {
+    selectRange(arr, left, right, ranks[rLo], badSplits);
+    return;
+  }
+  if (right - left < SELECT_SMALL) {
+    insertionSort(arr, left, right);
+    return;
+  }
+  int size = right - left + 1;
+  int pivot = badSplits > 0 ? arr[medianOfThree(arr, left, right)]
+                            : medianOfMedians(arr, left, right);
+  int lt, gt;
+  partitionThreeWay(arr, left, right, pivot, lt, gt);
+
+  // ranks 中 < lt 的去左侧, > gt 的去右侧, 其余已经就位
+  int leftEnd = lower_bound(ranks.begin() + rLo, ranks.begin() + rHi + 1, lt) -
+                ranks.begin() - 1;
+  int rightBegin =
+      upper_bound(ranks.begin() + rLo, ranks.begin() + rHi + 1, gt) -
+      ranks.begin();
+  int leftBudget = lt - left > size / 4 * 3 ? badSplits - 1 : badSplits;
+  int rightBudget = right - gt > size / 4 * 3 ? badSplits - 1 : badSplits;
+
+  if (size >= THRESHOLD && depth <= 10 && rLo <= leftEnd &&
+      rightBegin <= rHi) {
+    auto leftFuture = async(launch::async, [&]() {
+      multiselect(arr, left, lt - 1, ranks, rLo, leftEnd, leftBudget,
+                  depth + 1);
+    });
+    multiselect(arr, gt + 1, right, ranks, rightBegin, rHi, rightBudget,
+                depth + 1);
+    leftFuture.wait();
+    return;
+  }
+  multiselect(arr, left, lt - 1, ranks, rLo, leftEnd, leftBudget, depth + 1);
+  multiselect(arr, gt + 1, right, ranks, rightBegin, rHi, rightBudget,
+              depth + 1);
+}
+
+// 分位数 q (0 <= q <= 1) 取第 floor(q * (n - 1)) 小的元素;
+// 所有分位数一次选出, 结果与 qs 一一对应。
+// arr 为空, 或有 q 不在 [0, 1] 内 (包括 NaN) 时没有定义, 返回空
+vector<int> selectQuantiles(vector<int> &arr, const vector<double> &qs) {
+  INSTRUMENT_SCOPE("select.quantiles");
+  if (arr.empty()) {
+    return {};
+  }
+  vector<int> ranks;
+  for (double q : qs) {
+    if (!(q >= 0 && q <= 1)) {
+      return {};
+    }
+    ranks.push_back((int)(q * (arr.size() - 1)));
+  }
+  vector<int> sorted = ranks;
+  sort(sorted.begin(), sorted.end());
+  sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+  multiselect(arr, 0, arr.size() - 1, sorted, 0, sorted.size() - 1,
+              badSplitBudget(arr.size()));
+  vector<int> result;
+  for (int r : ranks) {
+    result.push_back(arr[r]);
+  }
+  return result;
+}
+
+// 并行 top-k: 数组分成 threads 段, 每个线程用大小为 k 的小根堆保留本段
+// 最大的 k 个; 合并各堆后再做一次快速选择。返回最大的 k 个, 从大到小
+vector<int> topKParallel(const vector<int> &arr, int k, int threads = 0) {
+  k = min<int>(k, arr.size());
+  if (k <= 0) {
+    return {};
+  }
+  if (threads <= 0) {
+    threads = max(1u, thread::hardware_concurrency());
+  }
+  int n = arr.size();
+  threads = max(1, min(threads, n / THRESHOLD));
+  vector<vector<int>> heaps(threads);
+  auto worker = [&](int t) {
+    vector<int> &heap = heaps[t];
+    heap.reserve(k);
+    long long begin = (long long)n * t / threads;
+    long long end = (long long)n * (t + 1) / threads;
+    for (long long i = begin; i < end; i++) {
+      if ((int)heap.size() < k) {
+        heap.push_back(arr[i]);
+        push_heap(heap.begin(), heap.end(), greater<int>());
+      } else if (arr[i] > heap.front()) {
+        pop_heap(heap.begin(), heap.end(), greater<int>());
+        heap.back() = arr[i];
+        push_heap(heap.begin(), heap.end(), greater<int>());
+      }
+    }
+  };
+  vector<future<void>> futures;
+  for (int t = 1; t < threads; t++) {
+    futures.push_back(async(launch::async, worker, t));
+  }
+  worker(0);
+  for (auto &f : futures) {
+    f.wait();
+  }
+
+  vector<int> candidates;
+  for (const vector<int> &heap : heaps) {
+    candidates.insert(candidates.end(), heap.begin(), heap.end());
+  }
+  int cut = candidates.size() - k;
+  quickselect(candidates, cut);
+  vector<int> top(candidates.begin() + cut, candidates.end());
+  sort(top.begin(), top.end(), greater<int>());
+  return top;
+}
+
 // 读取数据
 bool readData(const string &filename, vector<int> &data) {
   ifstream infile(filename);
@@ -79,8 +318,12 @@ bool readData(const string &filename, vector<int> &data) {
     return false;
   }
 
-  int n;
+  int n = 0;
   infile >> n;
+  if (n < 0) {
+    cerr << "数据个数无效: " << n << endl;
+    return false;
+  }
   data.resize(n);
 
   for (int i = 0; i < n; i++) {
@@ -110,7 +353,117 @@ bool writeData(const string &filename, const vector<int> &data) {
   return true;
 }
 
-int main() {
+// 基准测试: 完全排序后按下标读取 vs 选择引擎。数据为 data.txt (n 为 0 时)
+// 或 n 个随机数; 另对只有 16 种取值的大量重复数据检查选择结果
+int benchSelect(int n) {
+  vector<int> data;
+  if (n <= 0) {
+    if (!readData("data.txt", data)) {
+      return 1;
+    }
+  } else {
+    mt19937 gen(42);
+    data.resize(n);
+    for (int &x : data) {
+      x = gen() % 1000000000;
+    }
+  }
+  n = data.size();
+  if (n == 0) {
+    cerr << "没有数据, 无法做选择测试" << endl;
+    return 1;
+  }
+  const vector<double> qs = {0.5, 0.9, 0.99, 0.999};
+  const int k = 100;
+
+  // 基准: 完全排序一次, 之后所有查询都只是读下标
+  vector<int> sorted = data;
+  instrument::Stopwatch watch;
+  quicksortParallel(sorted, 0, sorted.size() - 1);
+  double sortTime = watch.elapsedMs();
+  auto rankOf = [&](double q) { return (int)(q * (n - 1)); };
+
+  bool ok = true;
+  vector<int> work = data;
+  watch.reset();
+  quickselect(work, n / 2);
+  double medianTime = watch.elapsedMs();
+  ok = ok && work[n / 2] == sorted[n / 2];
+
+  work = data;
+  watch.reset();
+  vector<int> quantiles = selectQuantiles(work, qs);
+  double quantileTime = watch.elapsedMs();
+  for (size_t i = 0; i < qs.size(); i++) {
+    ok = ok && quantiles[i] == sorted[rankOf(qs[i])];
+  }
+
+  watch.reset();
+  vector<int> top = topKParallel(data, k);
+  double topTime = watch.elapsedMs();
+  ok = ok && equal(top.begin(), top.end(), sorted.rbegin());
+
+  work = data;
+  watch.reset();
+  nth_element(work.begin(), work.begin() + n / 2, work.end());
+  double nthTime = watch.elapsedMs();
+
+  cout << "========== 选择 vs 完全排序 (n = " << n << ", "
+       << thread::hardware_concurrency() << " 线程) ==========" << endl;
+  cout << fixed << setprecision(2);
+  cout << "完全排序 (quicksortParallel): " << sortTime << " 毫秒" << endl;
+  cout << "中位数 (quickselect):         " << medianTime << " 毫秒 ("
+       << sortTime / medianTime << "x)" << endl;
+  cout << "4 个分位数 (一次完成):        " << quantileTime << " 毫秒 ("
+       << sortTime / quantileTime << "x)" << endl;
+  cout << "top-" << k << " (并行小根堆):         " << topTime << " 毫秒 ("
+       << sortTime / topTime << "x)" << endl;
+  cout << "中位数 (std::nth_element):    " << nthTime << " 毫秒" << endl;
+  cout << "p50 / p90 / p99 / p99.9: " << quantiles[0] << " / " << quantiles[1]
+       << " / " << quantiles[2] << " / " << quantiles[3] << endl;
+
+  // 大量重复: 二路划分的选择会退化, 三路划分应与 std::sort 的结果一致
+  vector<int> dup(max(n, 1000));
+  for (size_t i = 0; i < dup.size(); i++) {
+    dup[i] = (i * 2654435761u) % 16;
+  }
+  vector<int> dupSorted = dup;
+  sort(dupSorted.begin(), dupSorted.end());
+  work = dup;
+  quickselect(work, work.size() / 3);
+  ok = ok && work[work.size() / 3] == dupSorted[dupSorted.size() / 3];
+  work = dup;
+  vector<int> dupQuantiles = selectQuantiles(work, qs);
+  for (size_t i = 0; i < qs.size(); i++) {
+    ok = ok && dupQuantiles[i] ==
+                   dupSorted[(int)(qs[i] * (dupSorted.size() - 1))];
+  }
+  vector<int> dupTop = topKParallel(dup, k);
+  ok = ok && equal(dupTop.begin(), dupTop.end(), dupSorted.rbegin());
+
+  // 空数组和不在 [0, 1] 内的分位数没有定义, 应返回空
+  vector<int> none;
+  ok = ok && selectQuantiles(none, qs).empty();
+  work = data;
+  ok = ok && selectQuantiles(work, {0.5, 1.5}).empty();
+  ok = ok && selectQuantiles(work, {-0.1}).empty();
+  ok = ok &&
+       selectQuantiles(work, {numeric_limits<double>::quiet_NaN()}).empty();
+  cout << "结果" << (ok ? "正确" : "错误") << endl;
+  return ok ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+  // 其他模式：./parallel_quicksort select [n]  (n 省略时使用 data.txt)
+  if (argc > 1) {
+    string mode = argv[1];
+    if (mode == "select") {
+      return benchSelect(argc > 2 ? stoi(argv[2]) : 0);
+    }
+    cerr << "未知模式: " << mode << endl;
+    return 1;
+  }
+
   vector<int> data;
 
   // 读取数据
@@ -120,11 +473,9 @@ int main() {
 
   // 多线程快速排序
   vector<int> parallelData = data;
-  auto start = chrono::high_resolution_clock::now();
+  instrument::Stopwatch watch;
   quicksortParallel(parallelData, 0, parallelData.size() - 1);
-  auto end = chrono::high_resolution_clock::now();
-  auto parallelDuration =
-      chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+  double parallelDuration = watch.elapsedMs();
 
   // 写入结果
   if (!writeData("sorted.txt", parallelData)) {
@@ -133,11 +484,9 @@ int main() {
 
   // STL sort 对比
   vector<int> stlData = data;
-  start = chrono::high_resolution_clock::now();
+  watch.reset();
   sort(stlData.begin(), stlData.end());
-  end = chrono::high_resolution_clock::now();
-  auto stlDuration =
-      chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+  double stlDuration = watch.elapsedMs();
 
   // 输出性能对比
   cout << "========== 性能对比 ==========" << endl;
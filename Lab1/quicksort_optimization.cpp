@@ -6,6 +6,8 @@
 #include <random>
 #include <vector>
 
+#include "../common/instrument.h"
+
 using namespace std;
 
 // ==================== 插入排序 ====================
@@ -158,21 +160,21 @@ bool writeData(const string &filename, const vector<int> &data) {
   return true;
 }
 
+// 打点放在整次排序上: 分区函数对每个子数组都执行一次, 在那里打点的开销
+// 会超过分区本身
 double measureTime(vector<int> data,
                    void (*sortFunc)(vector<int> &, int, int)) {
-  auto start = chrono::high_resolution_clock::now();
+  INSTRUMENT_SCOPE("quicksort.pivotStrategy");
+  instrument::Stopwatch watch;
   sortFunc(data, 0, data.size() - 1);
-  auto end = chrono::high_resolution_clock::now();
-  return chrono::duration_cast<chrono::microseconds>(end - start).count() /
-         1000.0;
+  return watch.elapsedMs();
 }
 
 double measureTimeHybrid(vector<int> data, int k) {
-  auto start = chrono::high_resolution_clock::now();
+  INSTRUMENT_SCOPE("quicksort.hybrid");
+  instrument::Stopwatch watch;
   quicksortHybrid(data, 0, data.size() - 1, k);
-  auto end = chrono::high_resolution_clock::now();
-  return chrono::duration_cast<chrono::microseconds>(end - start).count() /
-         1000.0;
+  return watch.elapsedMs();
 }
 
 // ==================== 主程序 ====================
@@ -7,6 +7,8 @@
 #include <limits>
 #include <vector>
 
+#include "../common/instrument.h"
+
 using namespace std;
 using namespace chrono;
 
@@ -49,6 +51,9 @@ PointPair naiveClosestPair(const vector<Point> &points) {
   return bruteForceClosestPair(points);
 }
 
+// 分阶段打点的最小子问题规模
+const size_t PHASE_MIN_POINTS = 1024;
+
 // 分治算法的主递归函数。
 // 时间复杂度: O(n log n)
 PointPair closestPairRecursive(const vector<Point> &points_by_x,
@@ -59,21 +64,26 @@ PointPair closestPairRecursive(const vector<Point> &points_by_x,
   }
 
   // 1. 分解(Divide): 将点集按x坐标分为左右两半。
+  //    各阶段单独打点, 不包含递归调用, 以免耗时在每一层重复累计;
+  //    只统计点数不少于 PHASE_MIN_POINTS 的子问题, 更小的子问题数量为
+  //    O(n), 打点的开销会超过阶段本身。整个递归的耗时见 closestPair.total。
   size_t mid_index = points_by_x.size() / 2;
   Point mid_point = points_by_x[mid_index];
 
-  vector<Point> left_half_x(points_by_x.begin(),
-                            points_by_x.begin() + mid_index);
-  vector<Point> right_half_x(points_by_x.begin() + mid_index,
-                             points_by_x.end());
-
-  vector<Point> left_half_y, right_half_y;
-  // 通过遍历y排序数组来高效地(O(n))构建左右两半的y排序数组。
-  for (const auto &p : points_by_y) {
-    if (p.x < mid_point.x || (p.x == mid_point.x && p.y < mid_point.y)) {
-      left_half_y.push_back(p);
-    } else {
-      right_half_y.push_back(p);
+  vector<Point> left_half_x, right_half_x, left_half_y, right_half_y;
+  {
+    INSTRUMENT_SCOPE_IF("closestPair.divide",
+                        points_by_x.size() >= PHASE_MIN_POINTS);
+    left_half_x.assign(points_by_x.begin(), points_by_x.begin() + mid_index);
+    right_half_x.assign(points_by_x.begin() + mid_index, points_by_x.end());
+
+    // 通过遍历y排序数组来高效地(O(n))构建左右两半的y排序数组。
+    for (const auto &p : points_by_y) {
+      if (p.x < mid_point.x || (p.x == mid_point.x && p.y < mid_point.y)) {
+        left_half_y.push_back(p);
+      } else {
+        right_half_y.push_back(p);
+      }
     }
   }
 
@@ -87,6 +97,8 @@ PointPair closestPairRecursive(const vector<Point> &points_by_x,
 
   // 3. 合并(Combine): 寻找跨越中线的更近点对。
   //    只考虑距离中线小于delta的带状区域内的点。
+  INSTRUMENT_SCOPE_IF("closestPair.combine",
+                      points_by_x.size() >= PHASE_MIN_POINTS);
   vector<Point> strip_points;
   for (const auto &p : points_by_y) {
     if (abs(p.x - mid_point.x) < delta) {
@@ -135,7 +147,7 @@ int main() {
   }
 
   // --- 分治算法测试 ---
-  auto start_dc = high_resolution_clock::now();
+  instrument::Stopwatch watch_dc;
 
   vector<Point> points_by_x = points;
   vector<Point> points_by_y = points;
@@ -146,16 +158,18 @@ int main() {
   sort(points_by_y.begin(), points_by_y.end(),
        [](const Point &a, const Point &b) { return a.y < b.y; });
 
-  PointPair closest_pair = closestPairRecursive(points_by_x, points_by_y);
+  PointPair closest_pair;
+  {
+    INSTRUMENT_SCOPE("closestPair.total");
+    closest_pair = closestPairRecursive(points_by_x, points_by_y);
+  }
 
-  auto end_dc = high_resolution_clock::now();
-  duration<double, milli> duration_dc = end_dc - start_dc;
+  double duration_dc = watch_dc.elapsedMs();
 
   // --- 朴素暴力算法测试 ---
-  auto start_naive = high_resolution_clock::now();
+  instrument::Stopwatch watch_naive;
   PointPair naive_pair = naiveClosestPair(points);
-  auto end_naive = high_resolution_clock::now();
-  duration<double, milli> duration_naive = end_naive - start_naive;
+  double duration_naive = watch_naive.elapsedMs();
 
   // --- 输出结果 ---
   cout << "--- 分治算法结果 ---" << endl;
@@ -163,14 +177,14 @@ int main() {
        << closest_pair.p1.y << " 和 " << closest_pair.p2.id << " "
        << closest_pair.p2.x << " " << closest_pair.p2.y << endl;
   cout << "距离: " << fixed << setprecision(6) << closest_pair.distance << endl;
-  cout << "耗时: " << duration_dc.count() << " 毫秒" << endl;
+  cout << "耗时: " << duration_dc << " 毫秒" << endl;
 
   cout << "\n--- 朴素暴力算法结果 ---" << endl;
   cout << "最近点对: " << naive_pair.p1.id << " " << naive_pair.p1.x << " "
        << naive_pair.p1.y << " 和 " << naive_pair.p2.id << " "
        << naive_pair.p2.x << " " << naive_pair.p2.y << endl;
   cout << "距离: " << fixed << setprecision(6) << naive_pair.distance << endl;
-  cout << "耗时: " << duration_naive.count() << " 毫秒" << endl;
+  cout << "耗时: " << duration_naive << " 毫秒" << endl;
 
   return 0;
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include <fstream>
 #include <iostream>
 #include <queue>
+
+#include "../common/instrument.h"
 using namespace std;
 enum Color { RED, BLACK }; // 颜色枚举
 struct TNode {
@@ -55,6 +57,7 @@ private:
 
   // 插入修复
   void rbInsertFixup(TNode *z) {
+    INSTRUMENT_SCOPE("rbtree.insertFixup");
     while (z->p->color == RED) {
       if (z->p == z->p->p->left) {
         TNode *y = z->p->p->right; // 右叔叔节点
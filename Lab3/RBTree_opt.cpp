@@ -1,11 +1,41 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
 #include <fstream>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <queue>
+#include <random>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../common/instrument.h"
+
 using namespace std;
 
 enum Color { RED, BLACK }; // 颜色枚举
 
+// insertBatch 对一个批次采用的插入方式
+enum BatchPath { BATCH_PER_KEY, BATCH_FINGER, BATCH_REBUILD };
+
 struct TNode {
   int key;
   Color color;
@@ -14,6 +44,39 @@ struct TNode {
   TNode *p; // Parent
 };
 
+// 快照文件格式：文件头 + 按层次遍历顺序排列的节点记录。
+// 链接用记录下标表示（-1 表示 nil），与进程地址无关，mmap 后可直接读取。
+struct SnapshotHeader {
+  char magic[8];      // "RBTSNAP1"
+  uint64_t nodeCount; // 节点记录个数
+  uint64_t checksum;  // 节点记录区的校验和
+};
+
+struct SnapshotNode {
+  int32_t key;
+  int32_t color;
+  int32_t left;
+  int32_t right;
+  int32_t parent;
+};
+
+static const char SNAPSHOT_MAGIC[8] = {'R', 'B', 'T', 'S', 'N', 'A', 'P', '1'};
+
+// 64 位 FNV-1a，按 8 字节为单位累加以提高吞吐
+uint64_t snapshotChecksum(const char *data, size_t len) {
+  uint64_t h = 14695981039346656037ULL;
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, 8);
+    h = (h ^ word) * 1099511628211ULL;
+  }
+  for (; i < len; i++) {
+    h = (h ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+  }
+  return h;
+}
+
 class RedBlackTree {
 private:
   TNode *root;
@@ -24,6 +87,10 @@ private:
   vector<TNode *> memoryBlocks; // 存储所有申请的大内存块
   int freeIndex;                // 当前内存块用到第几个位置了
 
+  bool traceCases;  // 是否在插入修复时输出 case 编号（基准测试时关闭）
+  size_t nodeCount; // 树中节点个数
+  size_t rotations; // 累计旋转次数（批量插入据此判断 finger 是否失效）
+
   // 从内存池分配节点的辅助函数
   TNode *allocateNode(int key) {
     // 如果当前块用完了（或者还没申请过块），就申请一个新的大块
@@ -49,6 +116,7 @@ private:
 
   // 左旋
   void leftRotate(TNode *x) {
+    rotations++;
     TNode *y = x->right;
     x->right = y->left;
     if (y->left != nil) {
@@ -68,6 +136,7 @@ private:
 
   // 右旋
   void rightRotate(TNode *y) {
+    rotations++;
     TNode *x = y->left;
     y->left = x->right;
     if (x->right != nil) {
@@ -87,13 +156,15 @@ private:
 
   // 插入修复
   void rbInsertFixup(TNode *z) {
+    INSTRUMENT_SCOPE("rbtree.insertFixup");
     while (z->p->color == RED) {
       if (z->p == z->p->p->left) {
         TNode *y = z->p->p->right; // 右叔叔节点
 
         // Case 1
         if (y->color == RED) {
-          cout << "1 "; // 输出 Case 1
+          if (traceCases)
+            cout << "1 "; // 输出 Case 1
           z->p->color = BLACK;
           y->color = BLACK;
           z->p->p->color = RED;
@@ -101,12 +172,14 @@ private:
         } else {
           // Case 2
           if (z == z->p->right) {
-            cout << "2 "; // 输出 Case 2
+            if (traceCases)
+              cout << "2 "; // 输出 Case 2
             z = z->p;
             leftRotate(z);
           }
           // Case 3
-          cout << "3 "; // 输出 Case 3
+          if (traceCases)
+            cout << "3 "; // 输出 Case 3
           z->p->color = BLACK;
           z->p->p->color = RED;
           rightRotate(z->p->p);
@@ -116,7 +189,8 @@ private:
 
         // Case 4
         if (y->color == RED) {
-          cout << "4 "; // 输出 Case 4
+          if (traceCases)
+            cout << "4 "; // 输出 Case 4
           z->p->color = BLACK;
           y->color = BLACK;
           z->p->p->color = RED;
@@ -124,12 +198,14 @@ private:
         } else {
           // Case 5
           if (z == z->p->left) {
-            cout << "5 "; // 输出 Case 5
+            if (traceCases)
+              cout << "5 "; // 输出 Case 5
             z = z->p;
             rightRotate(z);
           }
           // Case 6
-          cout << "6 "; // 输出 Case 6
+          if (traceCases)
+            cout << "6 "; // 输出 Case 6
           z->p->color = BLACK;
           z->p->p->color = RED;
           leftRotate(z->p->p);
@@ -139,22 +215,300 @@ private:
     root->color = BLACK;
   }
 
-  // 先序遍历递归
-  void preOrderHelper(TNode *node, ofstream &ofs) {
-    if (node != nil) {
-      ofs << node->key << " " << (node->color == RED ? "RED" : "BLACK") << endl;
-      preOrderHelper(node->left, ofs);
-      preOrderHelper(node->right, ofs);
+  // 释放内存池中的全部节点，树恢复为空
+  void releasePool() {
+    for (TNode *block : memoryBlocks) {
+      delete[] block;
+    }
+    memoryBlocks.clear();
+    freeIndex = BLOCK_SIZE;
+    root = nil;
+    nodeCount = 0;
+  }
+
+  // 将节点 z 挂到 y 下方（y 为 nil 表示空树）并执行插入修复
+  void linkAndFixup(TNode *z, TNode *y) {
+    z->p = y;
+    if (y == nil) {
+      root = z;
+    } else if (z->key < y->key) {
+      y->left = z;
+    } else {
+      y->right = z;
+    }
+    nodeCount++;
+    rbInsertFixup(z);
+  }
+
+  // ================= 批量插入相关 =================
+  static constexpr int MAX_PATH = 128; // 红黑树高度不超过 2log(n+1)
+
+  // finger：上一次下降经过的根到叶路径，以及路径上每个子树的 key 上界（不含）
+  struct FingerPath {
+    TNode *node[MAX_PATH];
+    long long upper[MAX_PATH];
+    int depth;
+  };
+
+  // 为 key（不小于上一次插入的 key）寻找插入位置的父节点。
+  // 先从路径末端弹出上界不超过 key 的节点（只比较路径中保存的上界，不访问
+  // 节点内存），剩下的最深节点的子树必然包含 key 的插入位置，再从它向下查找。
+  // 相邻 key 在树中距离较近时，只需重走路径的最后几层。
+  TNode *fingerSearch(FingerPath &f, int key) {
+    while (f.depth > 0 && key >= f.upper[f.depth - 1]) {
+      f.depth--;
     }
+    TNode *x = root;
+    long long upper = LLONG_MAX;
+    if (f.depth > 0) {
+      f.depth--;
+      x = f.node[f.depth];
+      upper = f.upper[f.depth];
+    }
+    TNode *y = nil;
+    while (x != nil) {
+      f.node[f.depth] = x;
+      f.upper[f.depth] = upper;
+      f.depth++;
+      y = x;
+      if (key < x->key) {
+        upper = x->key;
+        x = x->left;
+      } else {
+        x = x->right;
+      }
+    }
+    return y;
   }
 
-  // 中序遍历递归
-  void inOrderHelper(TNode *node, ofstream &ofs) {
-    if (node != nil) {
-      inOrderHelper(node->left, ofs);
-      ofs << node->key << " " << (node->color == RED ? "RED" : "BLACK") << endl;
-      inOrderHelper(node->right, ofs);
+  // 插入修复发生旋转后，被旋转的节点及其下方的路径记录失效：
+  // 从根往下找到第一条父指针不再匹配的边，截断路径
+  void repairFinger(FingerPath &f) {
+    if (f.depth == 0 || f.node[0] != root) {
+      f.depth = 0;
+      return;
     }
+    int d = 1;
+    while (d < f.depth && f.node[d]->p == f.node[d - 1]) {
+      d++;
+    }
+    f.depth = d;
+  }
+
+  // 中序收集全部 key
+  void collectKeys(vector<int> &keys) const {
+    inOrderVisit([&](const TNode *x) { keys.push_back(x->key); });
+  }
+
+  // ================= 有序批量构建相关 =================
+  static constexpr int BULK_THRESHOLD = 100000; // 子树小于该规模时不再开线程
+  static constexpr int BULK_MAX_DEPTH = 4;      // 最多并行展开的递归层数
+
+  // 在 nodes[lo, hi) 上以中点为根递归建立平衡 BST，返回子树根。
+  // nodes[i] 恰好存放第 i 小的 key，左右子树占用的区间互不相交，可以并行构建。
+  // 深度为 redDepth 的节点（最后一层不满时的叶子）染红，其余染黑，
+  // 这样每条根到叶的路径黑高相同，且不存在连续红节点。
+  template <typename RandomIt>
+  TNode *buildBalanced(TNode *nodes, RandomIt keys, int lo, int hi,
+                       TNode *parent, int depth, int redDepth, bool parallel) {
+    if (lo >= hi) {
+      return nil;
+    }
+    int mid = lo + (hi - lo) / 2;
+    TNode *node = &nodes[mid];
+    node->key = keys[mid];
+    node->color = (depth == redDepth) ? RED : BLACK;
+    node->p = parent;
+
+    if (parallel && hi - lo >= BULK_THRESHOLD && depth < BULK_MAX_DEPTH) {
+      auto leftFuture = async(launch::async, [&]() {
+        node->left = buildBalanced(nodes, keys, lo, mid, node, depth + 1,
+                                   redDepth, true);
+      });
+      node->right = buildBalanced(nodes, keys, mid + 1, hi, node, depth + 1,
+                                  redDepth, true);
+      leftFuture.wait();
+    } else {
+      node->left = buildBalanced(nodes, keys, lo, mid, node, depth + 1,
+                                 redDepth, false);
+      node->right = buildBalanced(nodes, keys, mid + 1, hi, node, depth + 1,
+                                  redDepth, false);
+    }
+    return node;
+  }
+
+  // 递归校验红黑性质与 BST 有序性，返回子树黑高；不合法时返回 -1
+  int checkHelper(TNode *node, long long lo, long long hi) {
+    if (node == nil) {
+      return 1;
+    }
+    if (node->key < lo || node->key > hi) {
+      return -1;
+    }
+    if (node->left != nil && node->left->p != node) {
+      return -1;
+    }
+    if (node->right != nil && node->right->p != node) {
+      return -1;
+    }
+    if (node->color == RED &&
+        (node->left->color == RED || node->right->color == RED)) {
+      return -1;
+    }
+    int lh = checkHelper(node->left, lo, node->key);
+    int rh = checkHelper(node->right, node->key, hi);
+    if (lh < 0 || rh < 0 || lh != rh) {
+      return -1;
+    }
+    return lh + (node->color == BLACK ? 1 : 0);
+  }
+
+  // ================= 遍历与输出 =================
+  // 三种遍历都用显式栈/数组实现，树再深也不会耗尽调用栈
+
+  // 中序遍历 (LNR)
+  template <typename Visit> void inOrderVisit(Visit visit) const {
+    vector<TNode *> stack;
+    stack.reserve(MAX_PATH);
+    TNode *x = root;
+    while (x != nil || !stack.empty()) {
+      while (x != nil) {
+        stack.push_back(x);
+        x = x->left;
+      }
+      x = stack.back();
+      stack.pop_back();
+      visit(x);
+      x = x->right;
+    }
+  }
+
+  // 先序遍历 (NLR)
+  template <typename Visit> void preOrderVisit(Visit visit) const {
+    if (root == nil) {
+      return;
+    }
+    vector<TNode *> stack;
+    stack.reserve(MAX_PATH);
+    stack.push_back(root);
+    while (!stack.empty()) {
+      TNode *x = stack.back();
+      stack.pop_back();
+      visit(x);
+      if (x->right != nil) {
+        stack.push_back(x->right);
+      }
+      if (x->left != nil) {
+        stack.push_back(x->left);
+      }
+    }
+  }
+
+  // 层次遍历 (LOT)，用数组加头指针代替 queue
+  template <typename Visit> void levelOrderVisit(Visit visit) const {
+    if (root == nil) {
+      return;
+    }
+    vector<TNode *> order;
+    order.reserve(nodeCount);
+    order.push_back(root);
+    for (size_t head = 0; head < order.size(); head++) {
+      TNode *x = order[head];
+      visit(x);
+      if (x->left != nil) {
+        order.push_back(x->left);
+      }
+      if (x->right != nil) {
+        order.push_back(x->right);
+      }
+    }
+  }
+
+  // 把一个节点追加到输出缓冲区。
+  // 文本格式为 "key RED/BLACK" 一行；二进制格式为 4 字节 key（本机字节序）
+  // 加 1 字节颜色（0 = RED, 1 = BLACK）。
+  static void appendRecord(string &buf, const TNode *node, bool binary) {
+    if (binary) {
+      int32_t key = node->key;
+      buf.append(reinterpret_cast<const char *>(&key), sizeof(key));
+      buf.push_back(node->color == RED ? 0 : 1);
+    } else {
+      char digits[16];
+      auto res = to_chars(digits, digits + sizeof(digits), node->key);
+      buf.append(digits, res.ptr);
+      buf.append(node->color == RED ? " RED\n" : " BLACK\n");
+    }
+  }
+
+  // 整个缓冲区一次写入文件
+  static bool writeBuffer(const string &filename, const string &buf) {
+    ofstream ofs(filename, ios::binary);
+    if (!ofs.is_open()) {
+      cerr << "Error: cannot create " << filename << endl;
+      return false;
+    }
+    ofs.write(buf.data(), buf.size());
+    return ofs.good();
+  }
+
+  // 检查记录是否构成一棵合法的红黑树，保证加载后的遍历不会越界或死循环：
+  // 1. 记录按层次遍历顺序排列：0 号为黑色的根，没有父节点；其余记录的
+  //    父节点下标更小，且父节点的左或右链接正好指回它；
+  // 2. 孩子下标大于自身、父链接指回自身，左右孩子不相同；
+  //    结合 1，每个非根记录恰有一个父节点，沿父链接必然回到根，不会成环；
+  // 3. 红节点没有红孩子，各路径黑高相同（孩子在后，从后往前自底向上计算）。
+  // key 的有序性不检查：乱序只影响查找结果，不影响遍历的安全。
+  static bool validSnapshotShape(const SnapshotNode *records, size_t n) {
+    if (n == 0) {
+      return true;
+    }
+    if (records[0].parent != -1 || records[0].color != BLACK) {
+      return false;
+    }
+    auto isRed = [&](int32_t idx) {
+      return idx >= 0 && records[idx].color == RED;
+    };
+    for (size_t i = 0; i < n; i++) {
+      const SnapshotNode &r = records[i];
+      if (r.color != RED && r.color != BLACK) {
+        return false;
+      }
+      if (i > 0) {
+        if (r.parent < 0 || (size_t)r.parent >= i) {
+          return false;
+        }
+        const SnapshotNode &parent = records[r.parent];
+        if (parent.left != (int32_t)i && parent.right != (int32_t)i) {
+          return false;
+        }
+      }
+      for (int32_t child : {r.left, r.right}) {
+        if (child == -1) {
+          continue;
+        }
+        if (child <= (int64_t)i || child >= (int64_t)n ||
+            records[child].parent != (int32_t)i) {
+          return false;
+        }
+      }
+      if (r.left != -1 && r.left == r.right) {
+        return false;
+      }
+      if (r.color == RED && (isRed(r.left) || isRed(r.right))) {
+        return false;
+      }
+    }
+    vector<int32_t> blackHeight(n);
+    for (size_t i = n; i-- > 0;) {
+      const SnapshotNode &r = records[i];
+      int32_t left = r.left < 0 ? 0 : blackHeight[r.left];
+      int32_t right = r.right < 0 ? 0 : blackHeight[r.right];
+      if (left != right) {
+        return false;
+      }
+      blackHeight[i] = left + (r.color == BLACK);
+    }
+    return true;
   }
 
 public:
@@ -166,15 +520,136 @@ public:
 
     // 初始化内存池状态
     freeIndex = BLOCK_SIZE; // 设置为满，强制第一次插入时申请新块
+    traceCases = true;
+    nodeCount = 0;
+    rotations = 0;
   }
 
   // 析构函数：释放内存池
   ~RedBlackTree() {
     delete nil; // 释放哨兵
     // 批量释放内存块
-    for (TNode *block : memoryBlocks) {
-      delete[] block;
+    releasePool();
+  }
+
+  // 是否输出插入修复的 case 编号
+  void setTraceCases(bool enabled) { traceCases = enabled; }
+
+  // 树中节点个数
+  size_t size() const { return nodeCount; }
+
+  // 在当前树上插入 k 个 key 时 insertBatch 采用的方式 (见 insertBatch)
+  BatchPath batchPath(size_t k) const {
+    if (k * 64 < nodeCount) {
+      return BATCH_PER_KEY;
     }
+    return k * 4 >= nodeCount ? BATCH_REBUILD : BATCH_FINGER;
+  }
+
+  // 按中序收集全部 key
+  void collectAll(vector<int> &keys) const { collectKeys(keys); }
+
+  // 查找 key 是否存在
+  bool contains(int key) const {
+    TNode *x = root;
+    while (x != nil) {
+      if (key == x->key) {
+        return true;
+      }
+      x = (key < x->key) ? x->left : x->right;
+    }
+    return false;
+  }
+
+  // 从有序区间 [first, last) 批量构建红黑树，替换树中原有内容。
+  // 时间 O(n)：一次性申请 n 个节点的内存块，按中点递归建树并直接染色，无旋转。
+  // parallel 为 true 时，较大的左子树交给新线程构建。
+  // 输入不是非降序时返回 false，树保持不变。
+  template <typename RandomIt>
+  bool bulkLoad(RandomIt first, RandomIt last, bool parallel = false) {
+    if (!is_sorted(first, last)) {
+      return false;
+    }
+    releasePool();
+    int n = last - first;
+    if (n == 0) {
+      return true;
+    }
+
+    // 满层数 H = floor(log2(n + 1))，第 H 层（不满的最后一层）节点染红
+    int redDepth = 0;
+    while ((2LL << redDepth) - 1 <= n) {
+      redDepth++;
+    }
+
+    TNode *nodes = new TNode[n];
+    memoryBlocks.push_back(nodes);
+    root = buildBalanced(nodes, first, 0, n, nil, 0, redDepth, parallel);
+    root->color = BLACK;
+    nodeCount = n;
+    return true;
+  }
+
+  // 批量插入 [first, last) 中的 key（无需有序）。
+  // 批次不足树规模的 1/64 时，相邻 key 在树中相距太远，排序与 finger 都无收益，
+  // 直接逐个 insert；否则：
+  // 1. 先对批次排序；
+  // 2. 批次相对树较小时，一次性为整批申请内存块，按升序从上一次的插入路径
+  //    做 finger search，逐个挂接并执行插入修复（修复的均摊代价为 O(1)）；
+  // 3. 批次占树规模的 1/4 以上时，直接把树的中序序列与批次归并后用 bulkLoad
+  //    重建，整批只付出一次 O(n + k) 的代价，完全省去旋转与修复。
+  template <typename InputIt> void insertBatch(InputIt first, InputIt last) {
+    vector<int> batch(first, last);
+    if (batch.empty()) {
+      return;
+    }
+    BatchPath path = batchPath(batch.size());
+    if (path == BATCH_PER_KEY) {
+      for (int key : batch) {
+        insert(key);
+      }
+      return;
+    }
+    sort(batch.begin(), batch.end());
+
+    if (path == BATCH_REBUILD) {
+      vector<int> merged;
+      merged.reserve(nodeCount + batch.size());
+      collectKeys(merged);
+      size_t mid = merged.size();
+      merged.insert(merged.end(), batch.begin(), batch.end());
+      inplace_merge(merged.begin(), merged.begin() + mid, merged.end());
+      bulkLoad(merged.begin(), merged.end());
+      return;
+    }
+
+    int k = batch.size();
+    TNode *nodes = new TNode[k];
+    memoryBlocks.push_back(nodes);
+    freeIndex = BLOCK_SIZE; // 批次块已用满，后续 insert 会申请新块
+
+    FingerPath finger;
+    finger.depth = 0;
+    for (int i = 0; i < k; i++) {
+      TNode *z = &nodes[i];
+      z->key = batch[i];
+      z->color = RED;
+      z->left = z->right = nil;
+      TNode *y = fingerSearch(finger, z->key);
+      size_t before = rotations;
+      linkAndFixup(z, y);
+      if (rotations != before) {
+        repairFinger(finger);
+      }
+    }
+  }
+
+  // 校验整棵树是否满足红黑性质（用于基准测试中的正确性检查）
+  bool isValid() {
+    if (root->color != BLACK) {
+      return false;
+    }
+    return checkHelper(root, LLONG_MIN, LLONG_MAX) > 0;
   }
 
   // 插入函数
@@ -193,46 +668,636 @@ public:
         x = x->right;
       }
     }
-    z->p = y;
-    if (y == nil) {
-      root = z;
-    } else if (z->key < y->key) {
-      y->left = z;
+    linkAndFixup(z, y);
+  }
+
+  // 生成文件输出：LNR / NLR / LOT 三个遍历文件。
+  // 每个文件先在内存中拼好，再一次性写出；parallel 为 true 时三个文件
+  // 由三个线程同时生成；binary 为 true 时输出 .bin 二进制格式。
+  void generateOutputs(bool parallel = false, bool binary = false,
+                       const string &prefix = "") {
+    string ext = binary ? ".bin" : ".txt";
+    size_t reserveBytes = nodeCount * (binary ? 5 : 18);
+    auto dump = [&](const string &name, auto traverse) {
+      string buf;
+      buf.reserve(reserveBytes);
+      traverse([&](const TNode *x) { appendRecord(buf, x, binary); });
+      writeBuffer(prefix + name + ext, buf);
+    };
+    auto dumpLNR = [&]() {
+      dump("LNR_opt", [&](auto visit) { inOrderVisit(visit); });
+    };
+    auto dumpNLR = [&]() {
+      dump("NLR_opt", [&](auto visit) { preOrderVisit(visit); });
+    };
+    auto dumpLOT = [&]() {
+      dump("LOT_opt", [&](auto visit) { levelOrderVisit(visit); });
+    };
+
+    if (parallel) {
+      auto lnrFuture = async(launch::async, dumpLNR);
+      auto nlrFuture = async(launch::async, dumpNLR);
+      dumpLOT();
+      lnrFuture.wait();
+      nlrFuture.wait();
     } else {
-      y->right = z;
+      dumpLNR();
+      dumpNLR();
+      dumpLOT();
     }
-    rbInsertFixup(z);
   }
 
-  // 生成文件输出
+  // ================= 持久化快照 =================
+  // 按层次遍历顺序把节点写成下标链接的记录（根为 0 号），附带校验和
+  bool saveSnapshot(const string &filename) const {
+    vector<SnapshotNode> records;
+    records.reserve(nodeCount);
+    if (root != nil) {
+      vector<TNode *> order;
+      order.reserve(nodeCount);
+      order.push_back(root);
+      records.push_back({root->key, root->color, -1, -1, -1});
+      for (size_t i = 0; i < order.size(); i++) {
+        TNode *x = order[i];
+        if (x->left != nil) {
+          records[i].left = order.size();
+          order.push_back(x->left);
+          records.push_back({x->left->key, x->left->color, -1, -1, (int)i});
+        }
+        if (x->right != nil) {
+          records[i].right = order.size();
+          order.push_back(x->right);
+          records.push_back({x->right->key, x->right->color, -1, -1, (int)i});
+        }
+      }
+    }
+
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.nodeCount = records.size();
+    header.checksum =
+        snapshotChecksum(reinterpret_cast<const char *>(records.data()),
+                         records.size() * sizeof(SnapshotNode));
+
+    ofstream ofs(filename, ios::binary);
+    if (!ofs.is_open()) {
+      cerr << "Error: cannot create " << filename << endl;
+      return false;
+    }
+    ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char *>(records.data()),
+              records.size() * sizeof(SnapshotNode));
+    return ofs.good();
+  }
+
+  // mmap 快照文件，校验后一次性申请整块节点，把下标链接换成指针。
+  // 记录不能直接当作节点使用（TNode 以指针链接），因此加载仍是 O(n)：
+  // 一次校验和扫描、一次结构检查与一次逐节点重建，省下的是解析文本与
+  // n 次插入（下降、旋转、修复）的开销。
+  // 文件损坏（魔数、长度、校验和或结构不合法）时返回 false，树保持不变。
+  bool loadSnapshot(const string &filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      cerr << "Error: cannot open " << filename << endl;
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SnapshotHeader)) {
+      close(fd);
+      cerr << "Error: invalid snapshot " << filename << endl;
+      return false;
+    }
+    size_t fileSize = st.st_size;
+    void *mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+      cerr << "Error: cannot mmap " << filename << endl;
+      return false;
+    }
+
+    const char *base = static_cast<const char *>(mapped);
+    const SnapshotHeader *header =
+        reinterpret_cast<const SnapshotHeader *>(base);
+    const SnapshotNode *records =
+        reinterpret_cast<const SnapshotNode *>(base + sizeof(SnapshotHeader));
+    size_t n = header->nodeCount;
+    bool ok = memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) ==
+                  0 &&
+              n <= INT_MAX &&
+              fileSize == sizeof(SnapshotHeader) + n * sizeof(SnapshotNode) &&
+              snapshotChecksum(reinterpret_cast<const char *>(records),
+                               n * sizeof(SnapshotNode)) == header->checksum;
+    ok = ok && validSnapshotShape(records, n);
+
+    TNode *nodes = (ok && n > 0) ? new TNode[n] : nullptr;
+    auto link = [&](int32_t idx) { return idx < 0 ? nil : &nodes[idx]; };
+    for (size_t i = 0; ok && i < n; i++) {
+      const SnapshotNode &r = records[i];
+      nodes[i].key = r.key;
+      nodes[i].color = r.color == RED ? RED : BLACK;
+      nodes[i].left = link(r.left);
+      nodes[i].right = link(r.right);
+      nodes[i].p = link(r.parent);
+    }
+    munmap(mapped, fileSize);
+
+    if (!ok) {
+      delete[] nodes;
+      cerr << "Error: corrupted snapshot " << filename << endl;
+      return false;
+    }
+    releasePool();
+    if (n > 0) {
+      memoryBlocks.push_back(nodes);
+      root = nodes;
+    }
+    nodeCount = n;
+    return true;
+  }
+};
+
+// ================= 写时复制快照红黑树 =================
+// 单写者、多读者的并发版本：
+// - 写者插入时复制根到插入点的整条路径（路径复制），在新节点上完成平衡后，
+//   原子地发布新的根；已发布的节点从此不可变，读者无锁地在任一版本上查找；
+// - 被替换下来的旧路径节点不能立刻回收（可能仍有读者在旧版本上），按照
+//   基于 epoch 的回收（EBR）暂存，等所有活跃读者都进入更新的 epoch 后，
+//   再归还到内存池的空闲链表中复用。
+// 节点没有父指针（否则路径复制需要连带修改所有孩子），平衡采用
+// Okasaki 的函数式红黑树插入：红-红冲突只会出现在新复制的路径节点上，
+// 因此可以直接在这些未发布的节点上原地重排。
+struct PNode {
+  int key;
+  Color color;
+  PNode *left;
+  PNode *right;
+};
+
+class SnapshotRBTree {
+public:
+  static constexpr int MAX_READERS = 64; // 读者槽位上限
+
+private:
+  static constexpr uint64_t IDLE = UINT64_MAX; // 读者槽位空闲标记
+  static constexpr int RECLAIM_INTERVAL = 64;  // 每插入多少次尝试回收一次
+
+  // 每个读者独占一条缓存行，避免伪共享
+  struct alignas(64) ReaderSlot {
+    atomic<uint64_t> epoch;
+  };
+
+  atomic<PNode *> root;
+  atomic<uint64_t> globalEpoch;
+  ReaderSlot readers[MAX_READERS];
+  atomic<int> readerCount;
+
+  // ================= 内存池（仅写者访问） =================
+  const int BLOCK_SIZE = 1024;
+  vector<PNode *> memoryBlocks;
+  int freeIndex;
+  PNode *freeList; // 回收节点组成的空闲链表（借用 left 指针串联）
+
+  deque<pair<uint64_t, PNode *>> limbo; // 待回收节点及其退休时的 epoch
+  vector<PNode *> retiredPath;          // 本次插入替换下来的旧节点
+  size_t nodeCount;
+  size_t liveNodes; // 已分配且尚未归还空闲链表的节点数
+  int sinceReclaim;
+
+  PNode *allocateNode(int key, Color color, PNode *left, PNode *right) {
+    PNode *node;
+    if (freeList != nullptr) {
+      node = freeList;
+      freeList = node->left;
+    } else {
+      if (freeIndex >= BLOCK_SIZE || memoryBlocks.empty()) {
+        memoryBlocks.push_back(new PNode[BLOCK_SIZE]);
+        freeIndex = 0;
+      }
+      node = &memoryBlocks.back()[freeIndex++];
+    }
+    node->key = key;
+    node->color = color;
+    node->left = left;
+    node->right = right;
+    liveNodes++;
+    return node;
+  }
+
+  void freeNode(PNode *node) {
+    node->left = freeList;
+    freeList = node;
+    liveNodes--;
+  }
+
+  // Okasaki 平衡：z 为新复制的节点，若其孩子与孙子出现红-红冲突，
+  // 重排为“红根 + 两个黑孩子”。参与重排的三个节点都是本次新复制的。
+  PNode *balance(PNode *z) {
+    if (z->color != BLACK) {
+      return z;
+    }
+    PNode *l = z->left;
+    PNode *r = z->right;
+    if (l != nullptr && l->color == RED) {
+      if (l->left != nullptr && l->left->color == RED) {
+        PNode *x = l->left;
+        z->left = l->right;
+        l->left = x;
+        l->right = z;
+        x->color = BLACK;
+        z->color = BLACK;
+        l->color = RED;
+        return l;
+      }
+      if (l->right != nullptr && l->right->color == RED) {
+        PNode *x = l->right;
+        l->right = x->left;
+        z->left = x->right;
+        x->left = l;
+        x->right = z;
+        l->color = BLACK;
+        z->color = BLACK;
+        x->color = RED;
+        return x;
+      }
+    }
+    if (r != nullptr && r->color == RED) {
+      if (r->left != nullptr && r->left->color == RED) {
+        PNode *x = r->left;
+        z->right = x->left;
+        r->left = x->right;
+        x->left = z;
+        x->right = r;
+        z->color = BLACK;
+        r->color = BLACK;
+        x->color = RED;
+        return x;
+      }
+      if (r->right != nullptr && r->right->color == RED) {
+        PNode *x = r->right;
+        z->right = r->left;
+        r->left = z;
+        r->right = x;
+        z->color = BLACK;
+        x->color = BLACK;
+        r->color = RED;
+        return r;
+      }
+    }
+    return z;
+  }
+
+  // 路径复制插入：返回新版本子树的根，旧路径节点记入 retiredPath
+  PNode *insertCopy(PNode *t, int key) {
+    if (t == nullptr) {
+      return allocateNode(key, RED, nullptr, nullptr);
+    }
+    PNode *copy = allocateNode(t->key, t->color, t->left, t->right);
+    retiredPath.push_back(t);
+    if (key < t->key) {
+      copy->left = insertCopy(t->left, key);
+    } else {
+      copy->right = insertCopy(t->right, key);
+    }
+    return balance(copy);
+  }
+
+  // 回收所有退休 epoch 早于全部活跃读者的节点
+  void reclaim() {
+    uint64_t minActive = IDLE;
+    int count = min(readerCount.load(), MAX_READERS);
+    for (int i = 0; i < count; i++) {
+      minActive = min(minActive, readers[i].epoch.load());
+    }
+    while (!limbo.empty() && limbo.front().first < minActive) {
+      freeNode(limbo.front().second);
+      limbo.pop_front();
+    }
+  }
+
+  int checkHelper(PNode *node, long long lo, long long hi) const {
+    if (node == nullptr) {
+      return 1;
+    }
+    if (node->key < lo || node->key > hi) {
+      return -1;
+    }
+    if (node->color == RED &&
+        ((node->left != nullptr && node->left->color == RED) ||
+         (node->right != nullptr && node->right->color == RED))) {
+      return -1;
+    }
+    int lh = checkHelper(node->left, lo, node->key);
+    int rh = checkHelper(node->right, node->key, hi);
+    if (lh < 0 || rh < 0 || lh != rh) {
+      return -1;
+    }
+    return lh + (node->color == BLACK ? 1 : 0);
+  }
+
+public:
+  // 读者在一个快照上的访问凭证：构造时登记当前 epoch 并取得根，
+  // 析构时撤销登记。持有期间该版本的所有节点都不会被回收。
+  class ReadGuard {
+  public:
+    ReadGuard(SnapshotRBTree &tree, int readerId)
+        : slot(tree.readers[readerId].epoch) {
+      slot.store(tree.globalEpoch.load());
+      snapshot = tree.root.load();
+    }
+    ~ReadGuard() { slot.store(IDLE); }
+
+    bool contains(int key) const {
+      PNode *x = snapshot;
+      while (x != nullptr) {
+        if (key == x->key) {
+          return true;
+        }
+        x = (key < x->key) ? x->left : x->right;
+      }
+      return false;
+    }
+
+  private:
+    atomic<uint64_t> &slot;
+    PNode *snapshot;
+  };
+
+  SnapshotRBTree()
+      : root(nullptr), globalEpoch(0), readerCount(0), freeIndex(0),
+        freeList(nullptr), nodeCount(0), liveNodes(0), sinceReclaim(0) {
+    for (ReaderSlot &r : readers) {
+      r.epoch.store(IDLE);
+    }
+  }
+
+  // 析构时要求已没有活跃读者，整块释放内存池
+  ~SnapshotRBTree() {
+    for (PNode *block : memoryBlocks) {
+      delete[] block;
+    }
+  }
+
+  // 登记一个读者，返回其槽位编号；槽位用尽时返回 -1
+  int registerReader() {
+    int id = readerCount.fetch_add(1);
+    if (id >= MAX_READERS) {
+      readerCount.fetch_sub(1);
+      return -1;
+    }
+    return id;
+  }
+
+  // 无锁查找：在当前最新版本上查找 key
+  bool contains(int key, int readerId) {
+    ReadGuard guard(*this, readerId);
+    return guard.contains(key);
+  }
+
+  // 插入（仅允许单个写者线程调用）
+  void insert(int key) {
+    PNode *newRoot = insertCopy(root.load(memory_order_relaxed), key);
+    newRoot->color = BLACK;
+    root.store(newRoot);
+
+    // 发布新根之后，旧路径节点以当前 epoch 退休，再推进全局 epoch：
+    // 之后进入的读者只能看到新根
+    uint64_t e = globalEpoch.load(memory_order_relaxed);
+    for (PNode *node : retiredPath) {
+      limbo.emplace_back(e, node);
+    }
+    retiredPath.clear();
+    globalEpoch.store(e + 1);
+    nodeCount++;
+
+    if (++sinceReclaim >= RECLAIM_INTERVAL) {
+      sinceReclaim = 0;
+      reclaim();
+    }
+  }
+
+  // 在没有活跃读者时回收全部退休节点
+  void quiesce() { reclaim(); }
+
+  size_t size() const { return nodeCount; }
+
+  // 已分配且未回收的节点数（树中节点 + 尚在 limbo 中的节点）
+  size_t allocatedNodes() const { return liveNodes; }
+
+  // 校验最新版本的红黑性质（仅写者线程或无写者时调用）
+  bool isValid() const {
+    PNode *r = root.load();
+    if (r != nullptr && r->color != BLACK) {
+      return false;
+    }
+    return checkHelper(r, LLONG_MIN, LLONG_MAX) > 0;
+  }
+};
+
+// ================= 缓存友好的 B+ 树 =================
+// 二叉红黑树超出 L2 之后几乎每层都是一次缓存缺失；B+ 树每个节点存放 32 个
+// key（key 数组恰好两条缓存行，节点按 64 字节对齐），树高只有 log32(n)，
+// 节点内用 SIMD 一次比较 4 个 key。整个节点连同孩子指针共 448 字节
+// （7 条缓存行），但查找每层只读 key 数组、count 与选中的那一个孩子指针，
+// 即 3~4 条缓存行，其余孩子指针不会被读入。接口与 RedBlackTree 保持一致：
+// insert / contains / generateOutputs（LNR、NLR、LOT 三个输出文件）。
+// 插入采用 CLRS B-TREE-INSERT 的自顶向下分裂：下降时遇到满节点先分裂，
+// 保证父节点总有空位，不需要回溯。重复 key 插入到相等 key 的右侧。
+static constexpr int BPT_KEYS = 32; // 每个节点的 key 容量
+
+struct alignas(64) BPNode {
+  int keys[BPT_KEYS]; // 未使用的槽位填 INT_MAX，SIMD 比较时无需处理尾部
+  int count;
+  bool leaf;
+  BPNode *next;                   // 叶子链表，用于中序输出
+  BPNode *children[BPT_KEYS + 1]; // 内部节点的孩子
+};
+
+class BPlusTree {
+private:
+  BPNode *root;
+  size_t nodeCount;
+
+  // 内存池，与 RedBlackTree 相同的按块分配方式
+  const int BLOCK_SIZE = 1024;
+  vector<BPNode *> memoryBlocks;
+  int freeIndex;
+
+  BPNode *allocateNode(bool leaf) {
+    if (freeIndex >= BLOCK_SIZE || memoryBlocks.empty()) {
+      memoryBlocks.push_back(new BPNode[BLOCK_SIZE]);
+      freeIndex = 0;
+    }
+    BPNode *node = &memoryBlocks.back()[freeIndex++];
+    fill(node->keys, node->keys + BPT_KEYS, INT_MAX);
+    node->count = 0;
+    node->leaf = leaf;
+    node->next = nullptr;
+    return node;
+  }
+
+  // 统计节点中不大于 key 的 key 个数（即 upper_bound 位置）
+  static int countNotGreater(const BPNode *node, int key) {
+#if defined(__SSE2__)
+    __m128i target = _mm_set1_epi32(key);
+    int greater = 0;
+    int i = 0;
+    for (; i < node->count; i += 4) {
+      __m128i block =
+          _mm_load_si128(reinterpret_cast<const __m128i *>(node->keys + i));
+      __m128i gt = _mm_cmpgt_epi32(block, target);
+      greater += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(gt)));
+    }
+    // 读到的尾部填充槽位为 INT_MAX，key < INT_MAX 时会被算作“更大”
+    int le = i - greater;
+    return min(le, node->count);
+#else
+    int i = 0;
+    while (i < node->count && node->keys[i] <= key) {
+      i++;
+    }
+    return i;
+#endif
+  }
+
+  // 分裂 parent 的第 idx 个孩子（该孩子已满）
+  void splitChild(BPNode *parent, int idx) {
+    BPNode *child = parent->children[idx];
+    BPNode *right = allocateNode(child->leaf);
+    int half = BPT_KEYS / 2;
+    int separator;
+
+    if (child->leaf) {
+      // 叶子：右半部分整体移走，右叶第一个 key 复制到父节点作分隔
+      right->count = BPT_KEYS - half;
+      copy(child->keys + half, child->keys + BPT_KEYS, right->keys);
+      right->next = child->next;
+      child->next = right;
+      separator = right->keys[0];
+    } else {
+      // 内部节点：中间 key 上移，右半部分的 key 与孩子移走
+      separator = child->keys[half];
+      right->count = BPT_KEYS - half - 1;
+      copy(child->keys + half + 1, child->keys + BPT_KEYS, right->keys);
+      copy(child->children + half + 1, child->children + BPT_KEYS + 1,
+           right->children);
+    }
+    fill(child->keys + half, child->keys + BPT_KEYS, INT_MAX);
+    child->count = half;
+
+    // 在父节点的 idx 位置插入分隔 key 与新的右孩子
+    for (int i = parent->count; i > idx; i--) {
+      parent->keys[i] = parent->keys[i - 1];
+      parent->children[i + 1] = parent->children[i];
+    }
+    parent->keys[idx] = separator;
+    parent->children[idx + 1] = right;
+    parent->count++;
+  }
+
+  // 先序遍历：每个节点输出一行
+  void preOrderHelper(BPNode *node, ofstream &ofs) {
+    writeNode(node, ofs);
+    if (!node->leaf) {
+      for (int i = 0; i <= node->count; i++) {
+        preOrderHelper(node->children[i], ofs);
+      }
+    }
+  }
+
+  static void writeNode(BPNode *node, ofstream &ofs) {
+    for (int i = 0; i < node->count; i++) {
+      ofs << (i ? " " : "") << node->keys[i];
+    }
+    ofs << (node->leaf ? " LEAF" : " INNER") << "\n";
+  }
+
+public:
+  BPlusTree() : nodeCount(0), freeIndex(0) { root = allocateNode(true); }
+
+  ~BPlusTree() {
+    for (BPNode *block : memoryBlocks) {
+      delete[] block;
+    }
+  }
+
+  void insert(int key) {
+    if (root->count == BPT_KEYS) {
+      BPNode *newRoot = allocateNode(false);
+      newRoot->children[0] = root;
+      root = newRoot;
+      splitChild(newRoot, 0);
+    }
+    BPNode *x = root;
+    while (!x->leaf) {
+      int idx = countNotGreater(x, key);
+      if (x->children[idx]->count == BPT_KEYS) {
+        splitChild(x, idx);
+        if (key >= x->keys[idx]) {
+          idx++;
+        }
+      }
+      x = x->children[idx];
+    }
+    int pos = countNotGreater(x, key);
+    for (int i = x->count; i > pos; i--) {
+      x->keys[i] = x->keys[i - 1];
+    }
+    x->keys[pos] = key;
+    x->count++;
+    nodeCount++;
+  }
+
+  bool contains(int key) const {
+    const BPNode *x = root;
+    while (!x->leaf) {
+      x = x->children[countNotGreater(x, key)];
+    }
+    int pos = countNotGreater(x, key);
+    return pos > 0 && x->keys[pos - 1] == key;
+  }
+
+  size_t size() const { return nodeCount; }
+
+  // 中序收集全部 key（沿叶子链表）
+  vector<int> keysInOrder() const {
+    vector<int> keys;
+    keys.reserve(nodeCount);
+    const BPNode *x = root;
+    while (!x->leaf) {
+      x = x->children[0];
+    }
+    for (; x != nullptr; x = x->next) {
+      keys.insert(keys.end(), x->keys, x->keys + x->count);
+    }
+    return keys;
+  }
+
+  // 生成文件输出：LNR 每行一个 key，NLR / LOT 每行一个节点
   void generateOutputs() {
-    // 1. 中序遍历 (LNR)
-    ofstream lnrFile("LNR_opt.txt");
+    ofstream lnrFile("LNR_bpt.txt");
     if (lnrFile.is_open()) {
-      inOrderHelper(root, lnrFile);
+      for (int key : keysInOrder()) {
+        lnrFile << key << "\n";
+      }
       lnrFile.close();
     }
-    // 2. 先序遍历 (NLR)
-    ofstream nlrFile("NLR_opt.txt");
+    ofstream nlrFile("NLR_bpt.txt");
     if (nlrFile.is_open()) {
       preOrderHelper(root, nlrFile);
       nlrFile.close();
     }
-    // 3. 层次遍历 (LOT)
-    ofstream lotFile("LOT_opt.txt");
+    ofstream lotFile("LOT_bpt.txt");
     if (lotFile.is_open()) {
-      if (root != nil) {
-        queue<TNode *> q;
-        q.push(root);
-        while (!q.empty()) {
-          TNode *current = q.front();
-          q.pop();
-          lotFile << current->key << " "
-                  << (current->color == RED ? "RED" : "BLACK") << endl;
-          if (current->left != nil)
-            q.push(current->left);
-          if (current->right != nil)
-            q.push(current->right);
+      queue<BPNode *> q;
+      q.push(root);
+      while (!q.empty()) {
+        BPNode *current = q.front();
+        q.pop();
+        writeNode(current, lotFile);
+        if (!current->leaf) {
+          for (int i = 0; i <= current->count; i++) {
+            q.push(current->children[i]);
+          }
         }
       }
       lotFile.close();
@@ -240,7 +1305,422 @@ public:
   }
 };
 
-int main() {
+// 计时辅助：返回 func 的运行时间（毫秒）, 见 common/instrument.h
+using instrument::measureTime;
+
+// 生成 n 个有序随机 key
+vector<int> generateSortedKeys(int n) {
+  mt19937 gen(2024);
+  uniform_int_distribution<int> dis(0, INT_MAX);
+  vector<int> keys(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = dis(gen);
+  }
+  sort(keys.begin(), keys.end());
+  return keys;
+}
+
+// 基准测试：逐个 insert 与 bulkLoad（串行/并行）构建同一棵树的耗时对比
+int benchBulkLoad(int n) {
+  vector<int> keys = generateSortedKeys(n);
+  cout << "========== 有序批量构建 (n = " << n << ") ==========" << endl;
+
+  RedBlackTree perKey;
+  perKey.setTraceCases(false);
+  double insertTime = measureTime([&]() {
+    for (int key : keys) {
+      perKey.insert(key);
+    }
+  });
+
+  RedBlackTree serial;
+  double serialTime =
+      measureTime([&]() { serial.bulkLoad(keys.begin(), keys.end()); });
+
+  RedBlackTree parallel;
+  double parallelTime = measureTime(
+      [&]() { parallel.bulkLoad(keys.begin(), keys.end(), true); });
+
+  cout << fixed << setprecision(2);
+  cout << "逐个 insert:      " << insertTime << " 毫秒 ("
+       << (perKey.isValid() ? "合法" : "非法") << ")" << endl;
+  cout << "bulkLoad 串行:    " << serialTime << " 毫秒 ("
+       << (serial.isValid() ? "合法" : "非法") << ")" << endl;
+  cout << "bulkLoad 并行:    " << parallelTime << " 毫秒 ("
+       << (parallel.isValid() ? "合法" : "非法") << ")" << endl;
+  cout << "串行加速比: " << insertTime / serialTime << "x" << endl;
+  return 0;
+}
+
+// 基准测试：在已有 BASE 个 key 的树上，对比逐个 insert 与 insertBatch 的吞吐量
+// 批次规模按 1-2-5 递增，使三种插入方式都有若干行；每行标出实际走的方式
+int benchInsertBatch(int maxBatch) {
+  const int BASE = 1000000;
+  const char *const PATH_NAMES[] = {"逐个", "finger", "重建"};
+  vector<int> base = generateSortedKeys(BASE);
+  mt19937 gen(7);
+  uniform_int_distribution<int> dis(0, INT_MAX);
+
+  cout << "========== 批量插入 (已有 " << BASE << " 个 key) ==========" << endl;
+  cout << fixed << setprecision(2);
+  for (long long decade = 1000; decade <= maxBatch; decade *= 10) {
+    for (int step : {1, 2, 5}) {
+      long long k = decade * step;
+      if (k > maxBatch) {
+        break;
+      }
+      vector<int> batch(k);
+      for (int &key : batch) {
+        key = dis(gen);
+      }
+
+      RedBlackTree perKey;
+      perKey.setTraceCases(false);
+      perKey.bulkLoad(base.begin(), base.end());
+      double loopTime = measureTime([&]() {
+        for (int key : batch) {
+          perKey.insert(key);
+        }
+      });
+
+      RedBlackTree batched;
+      batched.setTraceCases(false);
+      batched.bulkLoad(base.begin(), base.end());
+      BatchPath path = batched.batchPath(batch.size());
+      double batchTime = measureTime(
+          [&]() { batched.insertBatch(batch.begin(), batch.end()); });
+
+      bool ok = perKey.isValid() && batched.isValid() &&
+                batched.size() == perKey.size();
+      cout << "k = " << setw(8) << k << ": 逐个 insert " << setw(10)
+           << loopTime << " 毫秒 (" << setw(7) << k / loopTime / 1000.0
+           << " M/s), insertBatch " << setw(10) << batchTime << " 毫秒 ("
+           << setw(7) << k / batchTime / 1000.0 << " M/s), 加速比 "
+           << loopTime / batchTime << "x, 方式: " << PATH_NAMES[path]
+           << (ok ? "" : " [校验失败]") << endl;
+    }
+  }
+  return 0;
+}
+
+// 基准测试：单写者插入 n 个 key 的同时，多个读者持续查找。
+// 对比写时复制快照树（读者无锁）与读写锁保护的 RedBlackTree。
+int benchConcurrent(int n, int readerThreads) {
+  vector<int> keys(n);
+  mt19937 gen(11);
+  uniform_int_distribution<int> dis(0, INT_MAX);
+  for (int i = 0; i < n; i++) {
+    keys[i] = dis(gen);
+  }
+
+  cout << "========== 并发读写 (n = " << n << ", 读者 " << readerThreads
+       << " 个) ==========" << endl;
+  cout << fixed << setprecision(2);
+
+  // 运行一轮：writer 完成全部插入后通知读者停止，返回 {写耗时, 读总次数}
+  auto runRound = [&](auto writer, auto reader) {
+    atomic<bool> done(false);
+    vector<long long> reads(readerThreads, 0);
+    vector<thread> pool;
+    for (int t = 0; t < readerThreads; t++) {
+      pool.emplace_back([&, t]() {
+        mt19937 local(100 + t);
+        uniform_int_distribution<int> pick(0, n - 1);
+        long long count = 0;
+        while (!done.load(memory_order_relaxed)) {
+          reader(t, keys[pick(local)]);
+          count++;
+        }
+        reads[t] = count;
+      });
+    }
+    double writeTime = measureTime(writer);
+    done.store(true);
+    for (thread &th : pool) {
+      th.join();
+    }
+    long long total = 0;
+    for (long long r : reads) {
+      total += r;
+    }
+    return make_pair(writeTime, total);
+  };
+
+  SnapshotRBTree snap;
+  vector<int> ids(readerThreads);
+  for (int t = 0; t < readerThreads; t++) {
+    ids[t] = snap.registerReader();
+  }
+  auto snapResult = runRound(
+      [&]() {
+        for (int key : keys) {
+          snap.insert(key);
+        }
+      },
+      [&](int t, int key) { snap.contains(key, ids[t]); });
+
+  RedBlackTree locked;
+  locked.setTraceCases(false);
+  shared_mutex mtx;
+  auto lockResult = runRound(
+      [&]() {
+        for (int key : keys) {
+          unique_lock<shared_mutex> lock(mtx);
+          locked.insert(key);
+        }
+      },
+      [&](int, int key) {
+        shared_lock<shared_mutex> lock(mtx);
+        locked.contains(key);
+      });
+
+  bool ok = snap.isValid() && snap.size() == (size_t)n;
+  for (int key : keys) {
+    ok = ok && snap.contains(key, ids[0]);
+  }
+  snap.quiesce();
+  ok = ok && snap.allocatedNodes() == snap.size();
+
+  cout << "快照树 (无锁读):   写 " << snapResult.first << " 毫秒, 读 "
+       << snapResult.second / snapResult.first / 1000.0 << " M/s" << endl;
+  cout << "读写锁 RBTree:     写 " << lockResult.first << " 毫秒, 读 "
+       << lockResult.second / lockResult.first / 1000.0 << " M/s" << endl;
+  cout << "快照树校验: " << (ok ? "通过" : "失败") << endl;
+  return ok ? 0 : 1;
+}
+
+// 基准测试：RedBlackTree、std::set 与 BPlusTree 的构建与查找耗时对比
+int benchOrderedIndex(int maxN) {
+  cout << "========== 有序索引对比 ==========" << endl;
+  cout << fixed << setprecision(2);
+  for (int n = 1000000; n <= maxN; n *= 10) {
+    mt19937 gen(n);
+    uniform_int_distribution<int> dis(0, INT_MAX);
+    vector<int> keys(n), queries(n);
+    for (int i = 0; i < n; i++) {
+      keys[i] = dis(gen);
+    }
+    // 一半查询命中已有 key，一半为随机值
+    for (int i = 0; i < n; i++) {
+      queries[i] = (i % 2 == 0) ? keys[dis(gen) % n] : dis(gen);
+    }
+
+    // 每种结构单独作用域，测完即释放，避免大规模时内存叠加
+    auto report = [&](const string &name, double buildTime, double findTime,
+                      long long hits) {
+      cout << "n = " << setw(9) << n << " " << name << ": 构建 " << setw(9)
+           << buildTime << " 毫秒, 查找 " << setw(9) << findTime
+           << " 毫秒 (命中 " << hits << ")" << endl;
+    };
+    {
+      RedBlackTree rbt;
+      rbt.setTraceCases(false);
+      double buildTime = measureTime([&]() {
+        for (int key : keys) {
+          rbt.insert(key);
+        }
+      });
+      long long hits = 0;
+      double findTime = measureTime([&]() {
+        for (int q : queries) {
+          hits += rbt.contains(q);
+        }
+      });
+      report("RedBlackTree", buildTime, findTime, hits);
+    }
+    {
+      set<int> st;
+      double buildTime = measureTime([&]() {
+        for (int key : keys) {
+          st.insert(key);
+        }
+      });
+      long long hits = 0;
+      double findTime = measureTime([&]() {
+        for (int q : queries) {
+          hits += st.count(q);
+        }
+      });
+      report("std::set    ", buildTime, findTime, hits);
+    }
+    {
+      BPlusTree bpt;
+      double buildTime = measureTime([&]() {
+        for (int key : keys) {
+          bpt.insert(key);
+        }
+      });
+      long long hits = 0;
+      double findTime = measureTime([&]() {
+        for (int q : queries) {
+          hits += bpt.contains(q);
+        }
+      });
+      report("BPlusTree   ", buildTime, findTime, hits);
+      vector<int> inOrder = bpt.keysInOrder();
+      if (inOrder.size() != (size_t)n ||
+          !is_sorted(inOrder.begin(), inOrder.end())) {
+        cout << "BPlusTree 校验失败" << endl;
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+// 基准测试：generateOutputs 的串行文本、并行文本与二进制三种输出方式
+int benchDump(int n) {
+  vector<int> keys = generateSortedKeys(n);
+  RedBlackTree rbt;
+  rbt.setTraceCases(false);
+  shuffle(keys.begin(), keys.end(), mt19937(5));
+  for (int key : keys) {
+    rbt.insert(key);
+  }
+
+  cout << "========== 遍历输出 (n = " << n << ") ==========" << endl;
+  cout << fixed << setprecision(2);
+  const string prefix = "bench_";
+  cout << "串行文本: "
+       << measureTime([&]() { rbt.generateOutputs(false, false, prefix); })
+       << " 毫秒" << endl;
+  cout << "并行文本: "
+       << measureTime([&]() { rbt.generateOutputs(true, false, prefix); })
+       << " 毫秒" << endl;
+  cout << "并行二进制: "
+       << measureTime([&]() { rbt.generateOutputs(true, true, prefix); })
+       << " 毫秒" << endl;
+  for (const string name : {"LNR_opt", "NLR_opt", "LOT_opt"}) {
+    remove((prefix + name + ".txt").c_str());
+    remove((prefix + name + ".bin").c_str());
+  }
+  return 0;
+}
+
+// 基准测试：冷启动耗时——从文本逐个 insert 重建 vs mmap 加载快照。
+// 加载快照仍是 O(n)（见 loadSnapshot），省去的是文本解析与逐个插入
+int benchStartup(int n) {
+  vector<int> keys = generateSortedKeys(n);
+  shuffle(keys.begin(), keys.end(), mt19937(3));
+  const string textFile = "bench_insert.txt";
+  const string snapFile = "bench_snapshot.bin";
+  {
+    ofstream ofs(textFile);
+    ofs << n << "\n";
+    for (int key : keys) {
+      ofs << key << " ";
+    }
+  }
+
+  cout << "========== 冷启动 (n = " << n << ") ==========" << endl;
+  cout << fixed << setprecision(2);
+
+  RedBlackTree rebuilt;
+  rebuilt.setTraceCases(false);
+  double rebuildTime = measureTime([&]() {
+    ifstream inputFile(textFile);
+    int count, val;
+    inputFile >> count;
+    for (int i = 0; i < count; i++) {
+      inputFile >> val;
+      rebuilt.insert(val);
+    }
+  });
+  double saveTime = measureTime([&]() { rebuilt.saveSnapshot(snapFile); });
+
+  RedBlackTree loaded;
+  bool ok = false;
+  double loadTime = measureTime([&]() { ok = loaded.loadSnapshot(snapFile); });
+
+  vector<int> expected, actual;
+  rebuilt.collectAll(expected);
+  loaded.collectAll(actual);
+  ok = ok && loaded.isValid() && expected == actual;
+
+  // 构造校验和正确但结构非法的快照：最后一条记录的左孩子指回根（成环）
+  bool rejected = true;
+  if (n > 1) {
+    ifstream ifs(snapFile, ios::binary);
+    string bytes((istreambuf_iterator<char>(ifs)),
+                 istreambuf_iterator<char>());
+    SnapshotNode *records =
+        reinterpret_cast<SnapshotNode *>(&bytes[sizeof(SnapshotHeader)]);
+    records[n - 1].left = 0;
+    SnapshotHeader *header = reinterpret_cast<SnapshotHeader *>(&bytes[0]);
+    header->checksum =
+        snapshotChecksum(reinterpret_cast<const char *>(records),
+                         n * sizeof(SnapshotNode));
+    ofstream(snapFile, ios::binary).write(bytes.data(), bytes.size());
+    RedBlackTree corrupted;
+    rejected = !corrupted.loadSnapshot(snapFile);
+  }
+
+  cout << "文本重建:   " << rebuildTime << " 毫秒" << endl;
+  cout << "保存快照:   " << saveTime << " 毫秒" << endl;
+  cout << "加载快照:   " << loadTime
+       << " 毫秒 (mmap + 校验和 + 结构检查 + O(n) 逐节点重建, "
+       << (ok ? "校验通过" : "校验失败") << ")" << endl;
+  cout << "加速比: " << rebuildTime / loadTime << "x" << endl;
+  cout << "成环的快照: " << (rejected ? "已拒绝" : "未被发现") << endl;
+  ok = ok && rejected;
+  remove(textFile.c_str());
+  remove(snapFile.c_str());
+  return ok ? 0 : 1;
+}
+
+// 用 insert.txt 构建 B+ 树并生成 LNR_bpt / NLR_bpt / LOT_bpt 三个输出文件
+int runBPlusTree() {
+  ifstream inputFile("insert.txt");
+  if (!inputFile.is_open()) {
+    cerr << "Error: did not found insert.txt" << endl;
+    return 1;
+  }
+  int n;
+  inputFile >> n;
+  BPlusTree bpt;
+  int val;
+  for (int i = 0; i < n; ++i) {
+    inputFile >> val;
+    bpt.insert(val);
+  }
+  inputFile.close();
+  bpt.generateOutputs();
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  // 其他模式：./RBTree_opt bulk [n] | batch [最大批次] | concurrent [n]
+  //           | index [最大 n] | bptree | dump [n] | startup [n]
+  if (argc > 1) {
+    string mode = argv[1];
+    int n = argc > 2 ? stoi(argv[2]) : 1000000;
+    if (mode == "bulk") {
+      return benchBulkLoad(n);
+    }
+    if (mode == "batch") {
+      return benchInsertBatch(argc > 2 ? n : 10000000);
+    }
+    if (mode == "index") {
+      // 默认测到 1000 万; 1 亿规模峰值约 5 GB 内存, 需显式传入 100000000
+      return benchOrderedIndex(argc > 2 ? n : 10000000);
+    }
+    if (mode == "dump") {
+      return benchDump(n);
+    }
+    if (mode == "startup") {
+      return benchStartup(n);
+    }
+    if (mode == "bptree") {
+      return runBPlusTree();
+    }
+    if (mode == "concurrent") {
+      int readers = max(2, (int)thread::hardware_concurrency() - 1);
+      return benchConcurrent(n, min(readers, SnapshotRBTree::MAX_READERS));
+    }
+    cerr << "Error: unknown mode " << mode << endl;
+    return 1;
+  }
+
   ifstream inputFile("insert.txt");
   if (!inputFile.is_open()) {
     cerr << "Error: did not found insert.txt" << endl;
@@ -1,44 +1,178 @@
 #include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
 #include <vector>
+
+#include "../common/instrument.h"
+
 using namespace std;
 
 // 颜色枚举
 enum Color { RED, BLACK };
 
-// 区间结构
-struct Interval {
-  int low;  // 区间下界
-  int high; // 区间上界
+// 区间结构，坐标类型 T 只需支持比较（int64_t、double、时间戳等）
+template <typename T> struct BasicInterval {
+  T low;  // 区间下界
+  T high; // 区间上界
 
-  Interval(int l = 0, int h = 0) : low(l), high(h) {}
+  BasicInterval(T l = T(), T h = T()) : low(l), high(h) {}
 
-  // 判断两个区间是否重叠
-  bool overlaps(const Interval &other) const {
+  // 判断两个闭区间是否重叠
+  bool overlaps(const BasicInterval &other) const {
     return low <= other.high && other.low <= high;
   }
 };
 
+using Interval = BasicInterval<int>;
+
+// 区间端点语义：before(end, start) 表示上界为 end 的区间完全落在
+// 下界为 start 的区间之前。两个区间重叠当且仅当谁也不在谁之前
+struct Closed { // [low, high]
+  template <typename T> static bool before(const T &end, const T &start) {
+    return end < start;
+  }
+};
+struct HalfOpen { // [low, high)
+  template <typename T> static bool before(const T &end, const T &start) {
+    return end <= start;
+  }
+};
+struct Open { // (low, high)
+  template <typename T> static bool before(const T &end, const T &start) {
+    return end <= start;
+  }
+};
+
+// 不携带值时的占位类型，不增加节点大小（见 NodeValue）
+struct NoValue {};
+
+// 批量查询结果（CSR 格式）：第 q 个查询的重叠区间为
+// intervals[offsets[q], offsets[q + 1])
+template <typename T> struct BasicOverlapBatchResult {
+  vector<size_t> offsets;             // 大小为查询数 + 1
+  vector<BasicInterval<T>> intervals; // 所有查询的结果依次拼接
+};
+
+using OverlapBatchResult = BasicOverlapBatchResult<int>;
+
+// 节点附带的值。V 为 NoValue 时是空基类，不占节点空间；
+// 此时 value 是静态成员，读写都不访问节点内存
+template <typename V> struct NodeValue {
+  V value = V(); // 区间附带的值
+};
+template <> struct NodeValue<NoValue> {
+  static inline NoValue value{};
+};
+
+// 子树大小增强，只有 Counted 为 true 的树（计数索引的伴随树）才带这个字段，
+// 普通区间树的节点保持原来的大小
+template <bool Counted> struct NodeSize {
+  int size = 1; // 以该节点为根的子树中的节点个数
+};
+template <> struct NodeSize<false> {};
+
 // 区间树节点
-struct IntervalNode {
-  Interval interval;    // 节点存储的区间
-  int max;              // 以该节点为根的子树中所有区间的最大上界
-  Color color;          // 节点颜色
-  IntervalNode *left;   // 左子节点
-  IntervalNode *right;  // 右子节点
-  IntervalNode *parent; // 父节点
-
-  IntervalNode(Interval i)
+template <typename T, typename V, bool Counted = false>
+struct BasicIntervalNode : NodeValue<V>, NodeSize<Counted> {
+  BasicInterval<T> interval; // 节点存储的区间
+  T max;                     // 以该节点为根的子树中所有区间的最大上界
+  Color color;               // 节点颜色
+  BasicIntervalNode *left;   // 左子节点
+  BasicIntervalNode *right;  // 右子节点
+  BasicIntervalNode *parent; // 父节点
+
+  BasicIntervalNode(BasicInterval<T> i = BasicInterval<T>())
       : interval(i), max(i.high), color(RED), left(nullptr), right(nullptr),
         parent(nullptr) {}
 };
 
-// 区间树类
-class IntervalTree {
+// 区间树类：T 为坐标类型，V 为每个区间附带的值（命中时直接取出，
+// 无需再查一次外部表），Bounds 为端点语义（Closed / HalfOpen / Open）。
+// Counted 为 true 时节点额外维护子树大小，支持 O(log n) 的按 low 计数
+// （countLowAfter / countLowBefore），供计数索引的伴随树使用
+template <typename T, typename V = NoValue, typename Bounds = Closed,
+          bool Counted = false>
+class BasicIntervalTree {
+public:
+  using Interval = BasicInterval<T>;
+  using IntervalNode = BasicIntervalNode<T, V, Counted>;
+  using OverlapBatchResult = BasicOverlapBatchResult<T>;
+
 private:
   IntervalNode *root;
   IntervalNode *NIL; // 哨兵节点，代表空节点
+  int nodeCount;     // 区间个数
+
+  // 计数索引：分别按 low、按 high 排序的两棵带子树大小的伴随树（存放
+  // Interval(low, low) 与 Interval(high, high)），启用后 countOverlaps 为
+  // O(log n)。主树节点不带 size，不启用时不付出任何代价
+  struct CountIndex {
+    BasicIntervalTree<T, NoValue, Bounds, true> lows;
+    BasicIntervalTree<T, NoValue, Bounds, true> highs;
+
+    void insert(const Interval &i) {
+      lows.insert(Interval(i.low, i.low));
+      highs.insert(Interval(i.high, i.high));
+    }
+
+    void erase(const Interval &i) {
+      lows.erase(Interval(i.low, i.low));
+      highs.erase(Interval(i.high, i.high));
+    }
+  };
+  unique_ptr<CountIndex> countIndex;
+
+  // ================= 内存池 =================
+  // 节点按块连续分配（没有每次 new 的分配头开销），删除的节点挂到空闲链表
+  // 上复用，析构时整块释放
+  static constexpr int BLOCK_SIZE = 4096; // 每个内存块的节点数
+  vector<IntervalNode *> memoryBlocks;    // 已申请的内存块
+  int freeIndex;                          // 当前块中下一个未用的位置
+  IntervalNode *freeList;                 // 已删除节点组成的空闲链表
+
+  IntervalNode *allocateNode(Interval interval, const V &value) {
+    IntervalNode *node;
+    if (freeList != nullptr) {
+      node = freeList;
+      freeList = node->parent;
+    } else {
+      if (freeIndex >= BLOCK_SIZE || memoryBlocks.empty()) {
+        memoryBlocks.push_back(new IntervalNode[BLOCK_SIZE]);
+        freeIndex = 0;
+      }
+      node = &memoryBlocks.back()[freeIndex++];
+    }
+    node->interval = interval;
+    node->max = interval.high;
+    if constexpr (Counted) {
+      node->size = 1;
+    }
+    node->color = RED;
+    node->value = value;
+    node->left = NIL;
+    node->right = NIL;
+    node->parent = NIL;
+    return node;
+  }
+
+  // 归还节点到空闲链表（借用 parent 指针串联）
+  void freeNode(IntervalNode *node) {
+    node->parent = freeList;
+    freeList = node;
+  }
 
   // 左旋操作
   void leftRotate(IntervalNode *x) {
@@ -94,11 +228,14 @@ private:
     updateMax(x);
   }
 
-  // 更新节点的max值
+  // 更新节点的max值（Counted 时同时维护子树大小 size）
   void updateMax(IntervalNode *node) {
     if (node == NIL)
       return;
 
+    if constexpr (Counted) {
+      node->size = node->left->size + node->right->size + 1;
+    }
     node->max = node->interval.high;
     if (node->left != NIL) {
       node->max = max(node->max, node->left->max);
@@ -110,6 +247,7 @@ private:
 
   // 插入后修复红黑树性质
   void insertFixup(IntervalNode *z) {
+    INSTRUMENT_SCOPE("intervalTree.insertFixup");
     while (z->parent->color == RED) {
       if (z->parent == z->parent->parent->left) {
         IntervalNode *y = z->parent->parent->right; // 叔节点
@@ -170,20 +308,173 @@ private:
     }
   }
 
+  // 用以 v 为根的子树替换以 u 为根的子树
+  void transplant(IntervalNode *u, IntervalNode *v) {
+    if (u->parent == NIL) {
+      root = v;
+    } else if (u == u->parent->left) {
+      u->parent->left = v;
+    } else {
+      u->parent->right = v;
+    }
+    v->parent = u->parent;
+  }
+
+  // 子树中 low 最小的节点
+  IntervalNode *minimum(IntervalNode *x) {
+    while (x->left != NIL) {
+      x = x->left;
+    }
+    return x;
+  }
+
+  // 查找与 i 完全相同的区间所在节点，不存在时返回 NIL。
+  // low 相同的区间经旋转后可能分布在左右两侧，因此相等时两边都要找；
+  // 子树 max 小于 i.high 时可直接剪枝。
+  IntervalNode *findNode(IntervalNode *x, Interval i) {
+    while (x != NIL && x->max >= i.high) {
+      if (i.low < x->interval.low) {
+        x = x->left;
+      } else if (i.low > x->interval.low) {
+        x = x->right;
+      } else {
+        if (x->interval.high == i.high) {
+          return x;
+        }
+        IntervalNode *found = findNode(x->left, i);
+        if (found != NIL) {
+          return found;
+        }
+        x = x->right;
+      }
+    }
+    return NIL;
+  }
+
+  // 删除后修复红黑树性质（CLRS RB-DELETE-FIXUP），旋转内部已维护max
+  void deleteFixup(IntervalNode *x) {
+    INSTRUMENT_SCOPE("intervalTree.deleteFixup");
+    while (x != root && x->color == BLACK) {
+      if (x == x->parent->left) {
+        IntervalNode *w = x->parent->right; // 兄弟节点
+        if (w->color == RED) {              // 情况1：兄弟是红色
+          w->color = BLACK;
+          x->parent->color = RED;
+          leftRotate(x->parent);
+          w = x->parent->right;
+        }
+        if (w->left->color == BLACK && w->right->color == BLACK) {
+          w->color = RED; // 情况2：兄弟的两个孩子都是黑色
+          x = x->parent;
+        } else {
+          if (w->right->color == BLACK) { // 情况3：兄弟的右孩子是黑色
+            w->left->color = BLACK;
+            w->color = RED;
+            rightRotate(w);
+            w = x->parent->right;
+          }
+          // 情况4：兄弟的右孩子是红色
+          w->color = x->parent->color;
+          x->parent->color = BLACK;
+          w->right->color = BLACK;
+          leftRotate(x->parent);
+          x = root;
+        }
+      } else { // 对称情况
+        IntervalNode *w = x->parent->left;
+        if (w->color == RED) {
+          w->color = BLACK;
+          x->parent->color = RED;
+          rightRotate(x->parent);
+          w = x->parent->left;
+        }
+        if (w->right->color == BLACK && w->left->color == BLACK) {
+          w->color = RED;
+          x = x->parent;
+        } else {
+          if (w->left->color == BLACK) {
+            w->right->color = BLACK;
+            w->color = RED;
+            leftRotate(w);
+            w = x->parent->left;
+          }
+          w->color = x->parent->color;
+          x->parent->color = BLACK;
+          w->left->color = BLACK;
+          rightRotate(x->parent);
+          x = root;
+        }
+      }
+    }
+    x->color = BLACK;
+  }
+
+  // 递归校验红黑性质、low 有序性、父指针与 max，返回黑高；不合法时返回 -1。
+  // lo / hi 为 low 的上下限，nullptr 表示无限制
+  int checkHelper(IntervalNode *x, const T *lo, const T *hi) {
+    if (x == NIL) {
+      return 1;
+    }
+    if ((lo && x->interval.low < *lo) || (hi && x->interval.low > *hi)) {
+      return -1;
+    }
+    if ((x->left != NIL && x->left->parent != x) ||
+        (x->right != NIL && x->right->parent != x)) {
+      return -1;
+    }
+    if (x->color == RED &&
+        (x->left->color == RED || x->right->color == RED)) {
+      return -1;
+    }
+    T expectedMax = x->interval.high;
+    if (x->left != NIL) {
+      expectedMax = max(expectedMax, x->left->max);
+    }
+    if (x->right != NIL) {
+      expectedMax = max(expectedMax, x->right->max);
+    }
+    if (x->max != expectedMax) {
+      return -1;
+    }
+    if constexpr (Counted) {
+      if (x->size != x->left->size + x->right->size + 1) {
+        return -1;
+      }
+    }
+    int lh = checkHelper(x->left, lo, &x->interval.low);
+    int rh = checkHelper(x->right, &x->interval.low, hi);
+    if (lh < 0 || rh < 0 || lh != rh) {
+      return -1;
+    }
+    return lh + (x->color == BLACK ? 1 : 0);
+  }
+
 public:
   // 构造函数
-  IntervalTree() {
-    NIL = new IntervalNode(Interval(0, 0));
+  BasicIntervalTree() : nodeCount(0), freeIndex(BLOCK_SIZE), freeList(nullptr) {
+    NIL = new IntervalNode();
+    if constexpr (Counted) {
+      NIL->size = 0;
+    }
     NIL->color = BLACK;
     NIL->left = NIL->right = NIL->parent = NIL;
     root = NIL;
   }
 
-  // 插入区间
-  void insert(Interval interval) {
-    IntervalNode *z = new IntervalNode(interval);
-    z->left = NIL;
-    z->right = NIL;
+  // 析构函数：整块释放内存池
+  ~BasicIntervalTree() {
+    for (IntervalNode *block : memoryBlocks) {
+      delete[] block;
+    }
+    delete NIL;
+  }
+
+  BasicIntervalTree(const BasicIntervalTree &) = delete;
+  BasicIntervalTree &operator=(const BasicIntervalTree &) = delete;
+
+  // 插入区间及其附带的值
+  void insert(Interval interval, const V &value = V()) {
+    IntervalNode *z = allocateNode(interval, value);
 
     IntervalNode *y = NIL;
     IntervalNode *x = root;
@@ -215,39 +506,333 @@ public:
 
     // 修复红黑树性质
     insertFixup(z);
+    nodeCount++;
+
+    if (countIndex) {
+      countIndex->insert(interval);
+    }
+  }
+
+  // 删除一个与 interval 完全相同的区间（存在多个时只删一个），
+  // 不存在时返回 false
+  bool erase(Interval interval) {
+    IntervalNode *z = findNode(root, interval);
+    if (z == NIL) {
+      return false;
+    }
+
+    IntervalNode *y = z;
+    Color yOriginalColor = y->color;
+    IntervalNode *x;
+    if (z->left == NIL) {
+      x = z->right;
+      transplant(z, z->right);
+    } else if (z->right == NIL) {
+      x = z->left;
+      transplant(z, z->left);
+    } else {
+      y = minimum(z->right); // z 的后继
+      yOriginalColor = y->color;
+      x = y->right;
+      if (y->parent == z) {
+        x->parent = y;
+      } else {
+        transplant(y, y->right);
+        y->right = z->right;
+        y->right->parent = y;
+      }
+      transplant(z, y);
+      y->left = z->left;
+      y->left->parent = y;
+      y->color = z->color;
+    }
+
+    // 结构发生变化的最低位置是 x 的父节点，从那里向上重算max
+    updateMaxToRoot(x->parent);
+    if (yOriginalColor == BLACK) {
+      deleteFixup(x);
+    }
+    if (countIndex) {
+      countIndex->erase(interval);
+    }
+    freeNode(z);
+    nodeCount--;
+    return true;
+  }
+
+  // 把一个已有区间的上界原地改为 newHigh（low 不变，树结构不变），
+  // 只需沿该节点到根的路径重算max。区间不存在时返回 false
+  bool updateHigh(Interval interval, T newHigh) {
+    IntervalNode *z = findNode(root, interval);
+    if (z == NIL) {
+      return false;
+    }
+    z->interval.high = newHigh;
+    updateMaxToRoot(z);
+    if (countIndex) {
+      countIndex->highs.erase(Interval(interval.high, interval.high));
+      countIndex->highs.insert(Interval(newHigh, newHigh));
+    }
+    return true;
+  }
+
+  // 校验红黑性质与 max / size 增强信息是否正确
+  bool isValid() {
+    if (root->color != BLACK) {
+      return false;
+    }
+    if (countIndex &&
+        (!countIndex->lows.isValid() || countIndex->lows.size() != size() ||
+         !countIndex->highs.isValid() || countIndex->highs.size() != size())) {
+      return false;
+    }
+    return checkHelper(root, nullptr, nullptr) > 0;
+  }
+
+  // 树中区间个数
+  int size() const { return nodeCount; }
+
+  // 整体落在上界 key 之后（Bounds::before(key, low)）的区间个数，O(log n)。
+  // 需要子树大小，只有 Counted 的树可用
+  int countLowAfter(const T &key) const {
+    static_assert(Counted, "countLowAfter 需要 Counted 区间树");
+    int count = 0;
+    IntervalNode *x = root;
+    while (x != NIL) {
+      if (Bounds::before(key, x->interval.low)) {
+        count += x->right->size + 1;
+        x = x->left;
+      } else {
+        x = x->right;
+      }
+    }
+    return count;
+  }
+
+  // low 落在下界 key 之前（Bounds::before(low, key)）的区间个数，O(log n)。
+  // 需要子树大小，只有 Counted 的树可用
+  int countLowBefore(const T &key) const {
+    static_assert(Counted, "countLowBefore 需要 Counted 区间树");
+    int count = 0;
+    IntervalNode *x = root;
+    while (x != NIL) {
+      if (Bounds::before(x->interval.low, key)) {
+        count += x->left->size + 1;
+        x = x->right;
+      } else {
+        x = x->left;
+      }
+    }
+    return count;
+  }
+
+  // 启用计数索引：建立按 low、按 high 排序的两棵伴随树，此后的插入、删除、
+  // 修改上界都会同步维护它们（代价是写操作大约为原来的三倍）
+  void enableCountIndex() {
+    if (countIndex) {
+      return;
+    }
+    countIndex.reset(new CountIndex());
+    forEachNode(root,
+                [&](IntervalNode *x) { countIndex->insert(x->interval); });
+  }
+
+  // CLRS INTERVAL-SEARCH：是否存在与 i 重叠的区间，找到一个即返回。
+  // hit / value 非空时写入找到的区间及其附带的值
+  bool anyOverlap(Interval i, Interval *hit = nullptr,
+                  V *value = nullptr) const {
+    IntervalNode *x = root;
+    while (x != NIL && !overlaps(i, x->interval)) {
+      if (x->left != NIL && !Bounds::before(x->left->max, i.low)) {
+        x = x->left;
+      } else {
+        x = x->right;
+      }
+    }
+    if (x == NIL) {
+      return false;
+    }
+    if (hit != nullptr) {
+      *hit = x->interval;
+    }
+    if (value != nullptr) {
+      *value = x->value;
+    }
+    return true;
+  }
+
+  // 与 i 重叠的区间个数。
+  // 不重叠的区间要么整体在 i 之后，要么整体在 i 之前（i 非空时两者不会
+  // 同时成立），因此个数 = 总数 - #(在 i.high 之后) - #(在 i.low 之前)。
+  // 启用计数索引时为 O(log n)，否则退化为不分配内存的逐个计数。
+  int countOverlaps(Interval i) const {
+    if (countIndex && !Bounds::before(i.high, i.low)) {
+      return size() - countIndex->lows.countLowAfter(i.high) -
+             countIndex->highs.countLowBefore(i.low);
+    }
+    int count = 0;
+    forEachOverlap(i, [&](const Interval &) { count++; });
+    return count;
+  }
+
+  // 对每个与 i 重叠的区间调用 visit(const Interval &)，流式输出、不分配内存
+  template <typename Visit> void forEachOverlap(Interval i, Visit visit) const {
+    auto onNode = [&](const IntervalNode *x) { visit(x->interval); };
+    visitOverlapsHelper(root, i, onNode);
+  }
+
+  // 同上，但调用 visit(const Interval &, V &)，可以直接读写附带的值
+  template <typename Visit>
+  void forEachOverlapWithValue(Interval i, Visit visit) const {
+    auto onNode = [&](IntervalNode *x) { visit(x->interval, x->value); };
+    visitOverlapsHelper(root, i, onNode);
   }
 
   // 查找所有与给定区间重叠的区间
-  vector<Interval> searchAllOverlaps(Interval i) {
+  vector<Interval> searchAllOverlaps(Interval i) const {
     vector<Interval> result;
-    searchAllOverlapsHelper(root, i, result);
+    searchAllOverlaps(i, back_inserter(result));
     return result;
   }
 
+  // 查找所有与给定区间重叠的区间，依次写入输出迭代器 out，
+  // 返回写完后的迭代器
+  template <typename OutputIt>
+  OutputIt searchAllOverlaps(const Interval &i, OutputIt out) const {
+    forEachOverlap(i, [&](const Interval &x) { *out++ = x; });
+    return out;
+  }
+
 private:
-  // 查找所有重叠区间的辅助函数
-  void searchAllOverlapsHelper(IntervalNode *x, Interval i,
-                               vector<Interval> &result) {
+  // 显式栈的大小：红黑树高度不超过 2·log2(n+1) <= 62（n 为 int），
+  // 每层最多留下一个待访问的右孩子，再加上当前出栈的节点
+  static constexpr int MAX_STACK = 128;
+
+  // 按 Bounds 语义判断两个区间是否重叠
+  static bool overlaps(const Interval &a, const Interval &b) {
+    return !Bounds::before(a.high, b.low) && !Bounds::before(b.high, a.low);
+  }
+
+  // 查找所有重叠区间的辅助函数：对每个重叠区间的节点调用 visit，自身不做任何
+  // 内存分配。用固定大小的栈代替递归，访问顺序与递归的前序遍历相同
+  // （当前节点、左子树、右子树）；压栈时预取即将访问的节点
+  template <typename Visit>
+  void visitOverlapsHelper(IntervalNode *x, const Interval &i,
+                           Visit &visit) const {
     if (x == NIL)
       return;
+    IntervalNode *stack[MAX_STACK];
+    int top = 0;
+    stack[top++] = x;
+    while (top > 0) {
+      x = stack[--top];
 
-    // 检查当前节点
-    if (i.overlaps(x->interval)) {
-      result.push_back(x->interval);
-    }
+      // 检查当前节点
+      if (overlaps(i, x->interval)) {
+        visit(x);
+      }
+
+      // 如果当前节点不在查询区间之后，则右子树稍后搜索
+      if (x->right != NIL && !Bounds::before(i.high, x->interval.low)) {
+#if defined(__GNUC__)
+        __builtin_prefetch(x->right);
+#endif
+        stack[top++] = x->right;
+      }
 
-    // 如果左子树可能包含重叠区间，则搜索左子树
-    if (x->left != NIL && x->left->max >= i.low) {
-      searchAllOverlapsHelper(x->left, i, result);
+      // 如果左子树可能包含重叠区间，则下一个搜索左子树；
+      // 它的 max 已读入缓存，顺带预取它的两个孩子
+      if (x->left != NIL && !Bounds::before(x->left->max, i.low)) {
+#if defined(__GNUC__)
+        __builtin_prefetch(x->left->left);
+        __builtin_prefetch(x->left->right);
+#endif
+        stack[top++] = x->left;
+      }
     }
+  }
 
-    // 如果当前节点的下界小于等于查询区间的上界，则搜索右子树
-    if (x->right != NIL && x->interval.low <= i.high) {
-      searchAllOverlapsHelper(x->right, i, result);
+  // 中序访问每个节点
+  template <typename Visit> void forEachNode(IntervalNode *x, Visit visit) {
+    if (x != NIL) {
+      forEachNode(x->left, visit);
+      visit(x);
+      forEachNode(x->right, visit);
     }
   }
 
 public:
+  // 批量查询：结果写入一个 CSR 结构，顺序与 queries 一致。
+  // 1. 按 low 排序查询的处理顺序，相邻查询走过的树路径大量重合，缓存命中更高；
+  // 2. 排好序的查询切成连续的段分给 threads 个线程（默认为 CPU 核数），
+  //    每个线程把结果追加到自己的缓冲区，并记下每个查询的起点与个数；
+  // 3. 按查询编号做前缀和得到 offsets，一次性分配结果数组，
+  //    各线程再把自己的结果并行拷贝到对应区段。
+  // 整个过程只有每个线程一个缓冲区的分配，没有逐查询的分配。
+  OverlapBatchResult searchAllOverlapsBatch(const vector<Interval> &queries,
+                                            int threads = 0) const {
+    size_t q = queries.size();
+    OverlapBatchResult out;
+    out.offsets.assign(q + 1, 0);
+    if (q == 0) {
+      return out;
+    }
+
+    vector<size_t> order(q);
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      const Interval &x = queries[a], &y = queries[b];
+      return x.low != y.low ? x.low < y.low : x.high < y.high;
+    });
+
+    if (threads <= 0) {
+      threads = max(1u, thread::hardware_concurrency());
+    }
+    size_t chunk = (q + threads - 1) / threads;
+    int workers = (q + chunk - 1) / chunk;
+
+    // 在每个线程上对 order[begin, end) 执行 work(t, begin, end)
+    auto runParallel = [&](auto work) {
+      vector<future<void>> futures;
+      for (int t = 1; t < workers; t++) {
+        futures.push_back(async(launch::async, [&, t]() {
+          work(t, t * chunk, min(q, (t + 1) * chunk));
+        }));
+      }
+      work(0, 0, min(q, chunk));
+      for (auto &f : futures) {
+        f.wait();
+      }
+    };
+
+    vector<vector<Interval>> buffers(workers);
+    vector<size_t> localStart(q);
+    runParallel([&](int t, size_t begin, size_t end) {
+      vector<Interval> &buf = buffers[t];
+      auto emit = [&](const IntervalNode *x) { buf.push_back(x->interval); };
+      for (size_t j = begin; j < end; j++) {
+        size_t id = order[j];
+        localStart[id] = buf.size();
+        visitOverlapsHelper(root, queries[id], emit);
+        out.offsets[id + 1] = buf.size() - localStart[id];
+      }
+    });
+
+    partial_sum(out.offsets.begin(), out.offsets.end(), out.offsets.begin());
+    out.intervals.resize(out.offsets[q]);
+
+    runParallel([&](int t, size_t begin, size_t end) {
+      const vector<Interval> &buf = buffers[t];
+      for (size_t j = begin; j < end; j++) {
+        size_t id = order[j];
+        size_t count = out.offsets[id + 1] - out.offsets[id];
+        copy(buf.begin() + localStart[id], buf.begin() + localStart[id] + count,
+             out.intervals.begin() + out.offsets[id]);
+      }
+    });
+    return out;
+  }
+
   // 中序遍历（用于调试）
   void inorder() { inorderHelper(root); }
 
@@ -264,7 +849,7 @@ public:
 
     // cout << "开始插入 " << n << " 个区间..." << endl;
     for (int i = 0; i < n; i++) {
-      int low, high;
+      T low, high;
       file >> low >> high;
       // cout << "插入区间 [" << low << ", " << high << "]" << endl;
       insert(Interval(low, high));
@@ -275,7 +860,874 @@ public:
   }
 };
 
-int main() {
+using IntervalTree = BasicIntervalTree<int>;
+
+// ================= 静态区间索引 =================
+// 面向“构建一次、查询多次”的场景：区间按 (low, high) 排序后存入
+// Eytzinger（BFS）顺序的隐式完全二叉树，节点 k 的孩子为 2k+1、2k+2，
+// 每个节点额外保存其子树的最大上界。查询的剪枝规则与 IntervalTree 相同，
+// 但没有指针，节点只有 12 字节，上层节点集中在数组开头，常驻缓存；
+// 向下访问时预取 4 层之后的后代（它们在数组中连续存放）。
+struct StaticNode {
+  int low;
+  int high;
+  int max; // 以该节点为根的子树中所有区间的最大上界
+};
+
+class StaticIntervalIndex {
+private:
+  vector<StaticNode> nodes;
+
+  // 按中序把有序区间依次填入隐式树，得到 Eytzinger 排列
+  void fillEytzinger(const vector<Interval> &sorted) {
+    size_t n = sorted.size();
+    size_t next = 0;
+    vector<size_t> stack;
+    size_t k = 0;
+    while (k < n || !stack.empty()) {
+      while (k < n) {
+        stack.push_back(k);
+        k = 2 * k + 1;
+      }
+      k = stack.back();
+      stack.pop_back();
+      nodes[k].low = sorted[next].low;
+      nodes[k].high = sorted[next].high;
+      next++;
+      k = 2 * k + 2;
+    }
+  }
+
+public:
+  // 由区间数组构建索引，O(n log n)
+  void build(vector<Interval> intervals) {
+    sort(intervals.begin(), intervals.end(),
+         [](const Interval &a, const Interval &b) {
+           return a.low != b.low ? a.low < b.low : a.high < b.high;
+         });
+    size_t n = intervals.size();
+    nodes.assign(n, StaticNode());
+    fillEytzinger(intervals);
+    // 自底向上计算子树最大上界
+    for (size_t k = n; k-- > 0;) {
+      int m = nodes[k].high;
+      if (2 * k + 1 < n) {
+        m = max(m, nodes[2 * k + 1].max);
+      }
+      if (2 * k + 2 < n) {
+        m = max(m, nodes[2 * k + 2].max);
+      }
+      nodes[k].max = m;
+    }
+  }
+
+  // 从文件读取区间（格式与 insert.txt 相同）并构建索引
+  bool buildFromFile(const string &filename) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+      cout << "无法打开文件: " << filename << endl;
+      return false;
+    }
+    int n;
+    file >> n;
+    vector<Interval> intervals(n);
+    for (int i = 0; i < n; i++) {
+      file >> intervals[i].low >> intervals[i].high;
+    }
+    build(intervals);
+    return true;
+  }
+
+  size_t size() const { return nodes.size(); }
+
+  // 查找所有与给定区间重叠的区间
+  vector<Interval> searchAllOverlaps(Interval i) const {
+    vector<Interval> result;
+    size_t n = nodes.size();
+    if (n == 0) {
+      return result;
+    }
+    size_t stack[128]; // 树高不超过 64，每层最多压入两个节点
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+      size_t k = stack[--top];
+      const StaticNode &x = nodes[k];
+      if (x.max < i.low) {
+        continue; // 整棵子树的上界都小于查询下界
+      }
+#if defined(__GNUC__)
+      if (16 * k + 15 < n) {
+        __builtin_prefetch(&nodes[16 * k + 15]);
+      }
+#endif
+      if (x.low <= i.high && i.low <= x.high) {
+        result.push_back(Interval(x.low, x.high));
+      }
+      // 右子树的 low 都不小于 x.low，x.low 已超过查询上界时无需访问
+      if (x.low <= i.high && 2 * k + 2 < n) {
+        stack[top++] = 2 * k + 2;
+      }
+      if (2 * k + 1 < n) {
+        stack[top++] = 2 * k + 1;
+      }
+    }
+    return result;
+  }
+};
+
+// ================= 区间连接 =================
+// 求两个区间集合 a、b 之间所有重叠的区间对，结果为下标对 (i, j)，
+// 表示 a[i] 与 b[j] 重叠。要求每个区间满足 low <= high（不满足的视为空区间）。
+using IndexPair = pair<int, int>;
+
+// 按 low 排序的下标（跳过 low > high 的空区间）
+vector<int> sortedByLow(const vector<Interval> &intervals) {
+  vector<int> order;
+  order.reserve(intervals.size());
+  for (int i = 0; i < (int)intervals.size(); i++) {
+    if (intervals[i].low <= intervals[i].high) {
+      order.push_back(i);
+    }
+  }
+  sort(order.begin(), order.end(), [&](int x, int y) {
+    return intervals[x].low < intervals[y].low;
+  });
+  return order;
+}
+
+// 在 low 位于 [lo, hi) 的片段上执行扫描线：
+// 按 low 从小到大合并两边的区间，每来一个区间，先把对方活动集合中
+// high < low 的区间移出，剩下的都与它重叠；然后把它加入己方活动集合。
+// 每个重叠对只在两者中 low 较大的那个到来时报告一次，所以片段开始前
+// 就已跨过 lo 的区间先放入活动集合而不报告，各片段的结果互不重复。
+void sweepJoin(const vector<Interval> &a, const vector<Interval> &b,
+               const vector<int> &orderA, const vector<int> &orderB,
+               long long lo, long long hi, vector<IndexPair> &out) {
+  auto firstNotLess = [](const vector<Interval> &s, const vector<int> &order,
+                         long long key) {
+    return (size_t)(partition_point(order.begin(), order.end(),
+                                    [&](int x) { return s[x].low < key; }) -
+                    order.begin());
+  };
+  size_t ia = firstNotLess(a, orderA, lo), ea = firstNotLess(a, orderA, hi);
+  size_t ib = firstNotLess(b, orderB, lo), eb = firstNotLess(b, orderB, hi);
+
+  vector<int> activeA, activeB;
+  for (size_t k = 0; k < ia; k++) {
+    if (a[orderA[k]].high >= lo) {
+      activeA.push_back(orderA[k]);
+    }
+  }
+  for (size_t k = 0; k < ib; k++) {
+    if (b[orderB[k]].high >= lo) {
+      activeB.push_back(orderB[k]);
+    }
+  }
+
+  // 扫描 active，移出已结束的区间，对其余区间调用 emit
+  auto scan = [](const vector<Interval> &s, vector<int> &active, int low,
+                 auto emit) {
+    for (size_t k = 0; k < active.size();) {
+      if (s[active[k]].high < low) {
+        active[k] = active.back();
+        active.pop_back();
+      } else {
+        emit(active[k]);
+        k++;
+      }
+    }
+  };
+
+  while (ia < ea || ib < eb) {
+    if (ib == eb || (ia < ea && a[orderA[ia]].low <= b[orderB[ib]].low)) {
+      int x = orderA[ia++];
+      scan(b, activeB, a[x].low, [&](int y) { out.emplace_back(x, y); });
+      activeA.push_back(x);
+    } else {
+      int y = orderB[ib++];
+      scan(a, activeA, b[y].low, [&](int x) { out.emplace_back(x, y); });
+      activeB.push_back(y);
+    }
+  }
+}
+
+// 单线程扫描线连接，O((n + m) log(n + m) + 结果数)
+vector<IndexPair> joinIntervals(const vector<Interval> &a,
+                                const vector<Interval> &b) {
+  vector<IndexPair> out;
+  sweepJoin(a, b, sortedByLow(a), sortedByLow(b), LLONG_MIN, LLONG_MAX, out);
+  return out;
+}
+
+// 分区并行连接：两边并行排序后，按 low 的分位数把坐标轴切成 threads 个
+// 片段（默认为 CPU 核数），每个线程独立扫描一个片段，结果按片段顺序拼接。
+// 结果集合与 joinIntervals 相同，但对的顺序可能不同。
+vector<IndexPair> joinIntervalsParallel(const vector<Interval> &a,
+                                        const vector<Interval> &b,
+                                        int threads = 0) {
+  if (threads <= 0) {
+    threads = max(1u, thread::hardware_concurrency());
+  }
+  auto sortA = async(launch::async, [&]() { return sortedByLow(a); });
+  vector<int> orderB = sortedByLow(b);
+  vector<int> orderA = sortA.get();
+
+  // 沿两边有序的 low 归并前进，取 n·t/threads 处的 low 作为片段边界
+  // （相同的边界合并，片段数可能少于 threads）
+  size_t n = orderA.size() + orderB.size();
+  size_t ia = 0, ib = 0;
+  auto nextIsA = [&]() {
+    return ib == orderB.size() ||
+           (ia < orderA.size() && a[orderA[ia]].low <= b[orderB[ib]].low);
+  };
+  vector<long long> bounds = {LLONG_MIN};
+  for (int t = 1; t < threads; t++) {
+    while (ia + ib < n * t / threads) {
+      nextIsA() ? ia++ : ib++;
+    }
+    if (ia + ib == n) {
+      break;
+    }
+    long long cut = nextIsA() ? a[orderA[ia]].low : b[orderB[ib]].low;
+    if (cut > bounds.back()) {
+      bounds.push_back(cut);
+    }
+  }
+  bounds.push_back(LLONG_MAX);
+
+  // 每个片段还要扫描一遍它之前的区间找出跨过边界的部分，
+  // 这部分是 O(n) 的额外开销，相对排序与结果输出可以忽略
+  int parts = bounds.size() - 1;
+  vector<vector<IndexPair>> results(parts);
+  vector<future<void>> futures;
+  for (int t = 1; t < parts; t++) {
+    futures.push_back(async(launch::async, [&, t]() {
+      sweepJoin(a, b, orderA, orderB, bounds[t], bounds[t + 1], results[t]);
+    }));
+  }
+  sweepJoin(a, b, orderA, orderB, bounds[0], bounds[1], results[0]);
+  for (auto &f : futures) {
+    f.wait();
+  }
+
+  // 按片段顺序拼接，各片段并行拷贝到各自的区段
+  vector<size_t> offsets(parts + 1, 0);
+  for (int t = 0; t < parts; t++) {
+    offsets[t + 1] = offsets[t] + results[t].size();
+  }
+  vector<IndexPair> out(offsets[parts]);
+  futures.clear();
+  for (int t = 1; t < parts; t++) {
+    futures.push_back(async(launch::async, [&, t]() {
+      copy(results[t].begin(), results[t].end(), out.begin() + offsets[t]);
+    }));
+  }
+  copy(results[0].begin(), results[0].end(), out.begin());
+  for (auto &f : futures) {
+    f.wait();
+  }
+  return out;
+}
+
+// 从文件读取区间数组（格式与 insert.txt 相同：首行个数，之后每行 low high）
+bool readIntervals(const string &filename, vector<Interval> &intervals) {
+  ifstream file(filename);
+  if (!file.is_open()) {
+    cout << "无法打开文件: " << filename << endl;
+    return false;
+  }
+  int n;
+  file >> n;
+  intervals.resize(n);
+  for (int i = 0; i < n; i++) {
+    file >> intervals[i].low >> intervals[i].high;
+  }
+  return true;
+}
+
+// 计时辅助：返回 func 的运行时间（毫秒）, 见 common/instrument.h
+using instrument::measureTime;
+
+// 生成随机区间，low 在 [0, range) 内，长度在 [0, maxLen] 内
+Interval randomInterval(mt19937 &gen, int range, int maxLen) {
+  uniform_int_distribution<int> lowDis(0, range - 1);
+  uniform_int_distribution<int> lenDis(0, maxLen);
+  int low = lowDis(gen);
+  return Interval(low, low + lenDis(gen));
+}
+
+// 比较两组区间是否为相同的多重集合（与顺序无关）
+bool sameIntervals(vector<Interval> a, vector<Interval> b) {
+  auto cmp = [](const Interval &x, const Interval &y) {
+    return x.low != y.low ? x.low < y.low : x.high < y.high;
+  };
+  sort(a.begin(), a.end(), cmp);
+  sort(b.begin(), b.end(), cmp);
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].low != b[i].low || a[i].high != b[i].high) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// 泛型实例的正确性检查：整数坐标 c 经 coord(c) 映射为 T（要求单调），
+// 区间 [l, h] 附带的值为 value(l, h)。随机插入 / 删除，定期与暴力结果
+// 对照重叠区间及其值、计数与存在性查询
+template <typename T, typename V, typename Bounds, typename Coord,
+          typename Value>
+bool checkGenericTree(int ops, Coord coord, Value value) {
+  using TreeInterval = BasicInterval<T>;
+  auto cmp = [](const TreeInterval &x, const TreeInterval &y) {
+    return x.low != y.low ? x.low < y.low : x.high < y.high;
+  };
+  mt19937 gen(17);
+  BasicIntervalTree<T, V, Bounds> tree;
+  tree.enableCountIndex();
+  vector<TreeInterval> reference;
+
+  for (int step = 1; step <= ops; step++) {
+    if (gen() % 10 < 6 || reference.empty()) {
+      Interval x = randomInterval(gen, 1000, 50);
+      TreeInterval t(coord(x.low), coord(x.high));
+      tree.insert(t, value(t.low, t.high));
+      reference.push_back(t);
+    } else {
+      size_t k = gen() % reference.size();
+      if (!tree.erase(reference[k])) {
+        return false;
+      }
+      reference[k] = reference.back();
+      reference.pop_back();
+    }
+
+    if (step % 50 == 0) {
+      Interval q = randomInterval(gen, 1000, 30);
+      TreeInterval query(coord(q.low), coord(q.high));
+      vector<TreeInterval> expected, got;
+      for (const TreeInterval &x : reference) {
+        if (!Bounds::before(x.high, query.low) &&
+            !Bounds::before(query.high, x.low)) {
+          expected.push_back(x);
+        }
+      }
+      bool valuesOk = true;
+      tree.forEachOverlapWithValue(query, [&](const TreeInterval &x, V &v) {
+        got.push_back(x);
+        valuesOk = valuesOk && v == value(x.low, x.high);
+      });
+      sort(expected.begin(), expected.end(), cmp);
+      sort(got.begin(), got.end(), cmp);
+      bool same = got.size() == expected.size();
+      for (size_t k = 0; same && k < got.size(); k++) {
+        same = !cmp(got[k], expected[k]) && !cmp(expected[k], got[k]);
+      }
+      V hitValue;
+      TreeInterval hit;
+      bool any = tree.anyOverlap(query, &hit, &hitValue);
+      if (!tree.isValid() || !same || !valuesOk ||
+          tree.countOverlaps(query) != (int)expected.size() ||
+          any != !expected.empty() ||
+          (any && !(hitValue == value(hit.low, hit.high)))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// 正确性检查：随机插入 / 删除 / 修改上界，与暴力维护的区间数组对照，
+// 每隔一段操作校验红黑性质、max / size 以及一次重叠查询、计数、存在性
+// 查询的结果
+int runCheck(int ops) {
+  mt19937 gen(42);
+  IntervalTree tree;
+  tree.enableCountIndex();
+  vector<Interval> reference;
+  uniform_int_distribution<int> opDis(0, 9);
+
+  for (int step = 1; step <= ops; step++) {
+    int op = opDis(gen);
+    if (op < 5 || reference.empty()) {
+      Interval interval = randomInterval(gen, 1000, 50);
+      tree.insert(interval);
+      reference.push_back(interval);
+    } else if (op < 8) {
+      size_t k = gen() % reference.size();
+      if (!tree.erase(reference[k])) {
+        cout << "第 " << step << " 步：删除已有区间失败" << endl;
+        return 1;
+      }
+      reference[k] = reference.back();
+      reference.pop_back();
+    } else {
+      size_t k = gen() % reference.size();
+      int newHigh = reference[k].low + gen() % 80;
+      if (!tree.updateHigh(reference[k], newHigh)) {
+        cout << "第 " << step << " 步：修改上界失败" << endl;
+        return 1;
+      }
+      reference[k].high = newHigh;
+    }
+
+    if (step % 100 == 0) {
+      Interval query = randomInterval(gen, 1000, 30);
+      vector<Interval> expected;
+      for (const Interval &interval : reference) {
+        if (query.overlaps(interval)) {
+          expected.push_back(interval);
+        }
+      }
+      vector<Interval> visited;
+      tree.forEachOverlap(query,
+                          [&](const Interval &hit) { visited.push_back(hit); });
+      Interval hit;
+      bool any = tree.anyOverlap(query, &hit);
+      if (!tree.isValid() ||
+          !sameIntervals(tree.searchAllOverlaps(query), expected) ||
+          !sameIntervals(visited, expected) ||
+          tree.countOverlaps(query) != (int)expected.size() ||
+          any != !expected.empty() || (any && !query.overlaps(hit))) {
+        cout << "第 " << step << " 步：校验失败" << endl;
+        return 1;
+      }
+    }
+  }
+  // 删除一个不存在的区间应返回 false
+  if (tree.erase(Interval(-5, -1))) {
+    cout << "删除不存在的区间却返回成功" << endl;
+    return 1;
+  }
+  cout << "随机操作 " << ops << " 次，校验通过（剩余 " << reference.size()
+       << " 个区间）" << endl;
+
+  // 其他坐标类型、附带值与端点语义的实例
+  using TimePoint = chrono::system_clock::time_point;
+  bool generic =
+      checkGenericTree<int64_t, int64_t, HalfOpen>(
+          ops / 4, [](int c) { return (int64_t)c << 32; },
+          [](int64_t l, int64_t h) { return (h - l) >> 32; }) &&
+      checkGenericTree<double, string, Open>(
+          ops / 4, [](int c) { return c * 0.5; },
+          [](double l, double h) {
+            return to_string(l) + "," + to_string(h);
+          }) &&
+      checkGenericTree<TimePoint, long long, Closed>(
+          ops / 4, [](int c) { return TimePoint(chrono::seconds(c)); },
+          [](TimePoint l, TimePoint h) {
+            return (long long)chrono::duration_cast<chrono::seconds>(h - l)
+                .count();
+          });
+  // 端点相接的 [1, 3] 与 [3, 5]：只有闭区间语义下算重叠
+  auto touches = [](auto &&t) {
+    t.insert(Interval(1, 3));
+    return t.anyOverlap(Interval(3, 5));
+  };
+  generic = generic && touches(BasicIntervalTree<int, NoValue, Closed>()) &&
+            !touches(BasicIntervalTree<int, NoValue, HalfOpen>()) &&
+            !touches(BasicIntervalTree<int, NoValue, Open>());
+  cout << "int64_t / double / 时间戳 实例校验"
+       << (generic ? "通过" : "失败") << endl;
+  return generic ? 0 : 1;
+}
+
+// 基准测试：预先插入 n 个区间后，执行 n 次混合操作
+// （40% 插入、30% 删除、20% 重叠查询、10% 修改上界）
+int benchMixed(int n) {
+  mt19937 gen(7);
+  const int RANGE = 100000000;
+  IntervalTree tree;
+  vector<Interval> live;
+  live.reserve(2 * n);
+  for (int i = 0; i < n; i++) {
+    live.push_back(randomInterval(gen, RANGE, 1000));
+    tree.insert(live.back());
+  }
+
+  // 预先生成操作序列，计时只包含树操作本身
+  vector<int> ops(n);
+  vector<Interval> args(n);
+  uniform_int_distribution<int> opDis(0, 9);
+  for (int i = 0; i < n; i++) {
+    ops[i] = opDis(gen);
+    args[i] = randomInterval(gen, RANGE, 1000);
+  }
+
+  long long found = 0;
+  double elapsed = measureTime([&]() {
+    for (int i = 0; i < n; i++) {
+      if (ops[i] < 4 || live.empty()) {
+        tree.insert(args[i]);
+        live.push_back(args[i]);
+      } else if (ops[i] < 7) {
+        size_t k = args[i].low % live.size();
+        tree.erase(live[k]);
+        live[k] = live.back();
+        live.pop_back();
+      } else if (ops[i] < 9) {
+        found += tree.searchAllOverlaps(args[i]).size();
+      } else {
+        size_t k = args[i].low % live.size();
+        int newHigh = live[k].low + (args[i].high - args[i].low);
+        tree.updateHigh(live[k], newHigh);
+        live[k].high = newHigh;
+      }
+    }
+  });
+
+  cout << "========== 混合操作 (n = " << n << ") ==========" << endl;
+  cout << fixed << setprecision(2);
+  cout << "耗时: " << elapsed << " 毫秒, 吞吐量: " << n / elapsed / 1000.0
+       << " M ops/s, 查询命中 " << found << " 个区间" << endl;
+  cout << "校验: " << (tree.isValid() ? "通过" : "失败") << endl;
+  return 0;
+}
+
+// 基准测试：n 个区间上执行 queries 次查询，对比物化结果后取 size()、
+// 访问者计数、O(log n) 计数索引与 anyOverlap 的耗时
+int benchCount(int n, int queries) {
+  mt19937 gen(11);
+  const int RANGE = 100000000;
+  IntervalTree tree;
+  for (int i = 0; i < n; i++) {
+    tree.insert(randomInterval(gen, RANGE, 1000));
+  }
+  double indexTime = measureTime([&]() { tree.enableCountIndex(); });
+  vector<Interval> qs(queries);
+  for (int i = 0; i < queries; i++) {
+    // 查询长度跨度较大，命中数从 0 到上千不等
+    qs[i] = randomInterval(gen, RANGE, 1 << (i % 20));
+  }
+
+  long long vectorHits = 0, visitHits = 0, countHits = 0, anyHits = 0;
+  double vectorTime = measureTime([&]() {
+    for (const Interval &q : qs) {
+      vectorHits += tree.searchAllOverlaps(q).size();
+    }
+  });
+  double visitTime = measureTime([&]() {
+    for (const Interval &q : qs) {
+      tree.forEachOverlap(q, [&](const Interval &) { visitHits++; });
+    }
+  });
+  double countTime = measureTime([&]() {
+    for (const Interval &q : qs) {
+      countHits += tree.countOverlaps(q);
+    }
+  });
+  double anyTime = measureTime([&]() {
+    for (const Interval &q : qs) {
+      anyHits += tree.anyOverlap(q);
+    }
+  });
+
+  bool ok = vectorHits == visitHits && vectorHits == countHits;
+  cout << "========== 计数 / 存在性查询 (n = " << n << ", 查询 " << queries
+       << " 次) ==========" << endl;
+  cout << fixed << setprecision(2);
+  cout << "建立计数索引: " << indexTime << " 毫秒" << endl;
+  cout << "searchAllOverlaps().size(): " << vectorTime << " 毫秒" << endl;
+  cout << "forEachOverlap 计数:        " << visitTime << " 毫秒" << endl;
+  cout << "countOverlaps:              " << countTime << " 毫秒" << endl;
+  cout << "anyOverlap:                 " << anyTime << " 毫秒 (" << anyHits
+       << " 个查询有重叠)" << endl;
+  cout << "命中 " << vectorHits << " 个区间，计数结果"
+       << (ok ? "一致" : "不一致") << endl;
+  return ok ? 0 : 1;
+}
+
+// 当前进程的常驻内存（MB），读取 /proc/self/statm，不支持的平台返回 0
+double currentRSSMB() {
+  FILE *f = fopen("/proc/self/statm", "r");
+  if (f == nullptr) {
+    return 0;
+  }
+  long pages = 0, resident = 0;
+  if (fscanf(f, "%ld %ld", &pages, &resident) != 2) {
+    resident = 0;
+  }
+  fclose(f);
+  return resident * (double)sysconf(_SC_PAGESIZE) / (1024 * 1024);
+}
+
+// 基准测试：n 个区间的构建耗时与内存占用。
+// 先重复建树两次，验证析构后内存池整块归还、不再泄漏；
+// 再按原来的方式为每个节点单独 new（只做分配，不建树）作为对照，
+// 衡量内存池省下的分配开销。
+int benchMemory(int n) {
+  using IntervalNode = IntervalTree::IntervalNode;
+  mt19937 gen(3);
+  vector<Interval> intervals(n);
+  for (int i = 0; i < n; i++) {
+    intervals[i] = randomInterval(gen, 100000000, 1000);
+  }
+  cout << "========== 内存池 (n = " << n << ") ==========" << endl;
+  cout << fixed << setprecision(2);
+
+  for (int round = 1; round <= 2; round++) {
+    double before = currentRSSMB();
+    IntervalTree tree;
+    double buildTime = measureTime([&]() {
+      for (const Interval &interval : intervals) {
+        tree.insert(interval);
+      }
+    });
+    double treeRSS = currentRSSMB() - before;
+    cout << "第 " << round << " 次建树: " << buildTime << " 毫秒, 内存 "
+         << treeRSS << " MB (" << treeRSS * 1024 * 1024 / n
+         << " 字节/区间), 节点大小 " << sizeof(IntervalNode) << " 字节"
+         << endl;
+  }
+  cout << "析构后进程内存: " << currentRSSMB() << " MB" << endl;
+
+  vector<IntervalNode *> loose(n);
+  double before = currentRSSMB();
+  double newTime = measureTime([&]() {
+    for (int i = 0; i < n; i++) {
+      loose[i] = new IntervalNode(intervals[i]);
+    }
+  });
+  double looseRSS = currentRSSMB() - before;
+  for (IntervalNode *node : loose) {
+    delete node;
+  }
+  cout << "对照：逐个 new 分配节点 " << newTime << " 毫秒, 内存 " << looseRSS
+       << " MB (" << looseRSS * 1024 * 1024 / n << " 字节/区间)" << endl;
+  return 0;
+}
+
+// 基准测试：同一批区间分别建 IntervalTree（作为正确性参照）与静态索引，
+// 对比 queries 次随机重叠查询的耗时，并逐个核对结果
+int benchStatic(int n, int queries) {
+  mt19937 gen(5);
+  const int RANGE = 100000000;
+  vector<Interval> intervals(n);
+  for (int i = 0; i < n; i++) {
+    intervals[i] = randomInterval(gen, RANGE, 1000);
+  }
+  vector<Interval> qs(queries);
+  for (int i = 0; i < queries; i++) {
+    qs[i] = randomInterval(gen, RANGE, 2000);
+  }
+
+  IntervalTree tree;
+  double treeBuild = measureTime([&]() {
+    for (const Interval &interval : intervals) {
+      tree.insert(interval);
+    }
+  });
+  StaticIntervalIndex index;
+  double indexBuild = measureTime([&]() { index.build(intervals); });
+
+  long long treeHits = 0, indexHits = 0;
+  double treeQuery = measureTime([&]() {
+    for (const Interval &q : qs) {
+      treeHits += tree.searchAllOverlaps(q).size();
+    }
+  });
+  double indexQuery = measureTime([&]() {
+    for (const Interval &q : qs) {
+      indexHits += index.searchAllOverlaps(q).size();
+    }
+  });
+
+  bool ok = treeHits == indexHits;
+  for (int i = 0; ok && i < min(queries, 10000); i++) {
+    ok = sameIntervals(tree.searchAllOverlaps(qs[i]),
+                       index.searchAllOverlaps(qs[i]));
+  }
+
+  cout << "========== 静态索引 (n = " << n << ", 查询 " << queries
+       << " 次) ==========" << endl;
+  cout << fixed << setprecision(2);
+  cout << "IntervalTree: 构建 " << treeBuild << " 毫秒, 查询 " << treeQuery
+       << " 毫秒" << endl;
+  cout << "静态索引:     构建 " << indexBuild << " 毫秒, 查询 " << indexQuery
+       << " 毫秒" << endl;
+  cout << "查询加速比: " << treeQuery / indexQuery << "x, 结果"
+       << (ok ? "一致" : "不一致") << " (命中 " << indexHits << ")" << endl;
+  return ok ? 0 : 1;
+}
+
+// 基准测试：逐个 searchAllOverlaps 与批量 CSR 查询的吞吐量对比
+int benchBatch(int n, int queries) {
+  mt19937 gen(9);
+  const int RANGE = 100000000;
+  IntervalTree tree;
+  for (int i = 0; i < n; i++) {
+    tree.insert(randomInterval(gen, RANGE, 1000));
+  }
+  vector<Interval> qs(queries);
+  for (int i = 0; i < queries; i++) {
+    qs[i] = randomInterval(gen, RANGE, 2000);
+  }
+
+  long long loopHits = 0;
+  double loopTime = measureTime([&]() {
+    for (const Interval &q : qs) {
+      loopHits += tree.searchAllOverlaps(q).size();
+    }
+  });
+  OverlapBatchResult batch;
+  double batchTime =
+      measureTime([&]() { batch = tree.searchAllOverlapsBatch(qs); });
+
+  bool ok = (long long)batch.intervals.size() == loopHits;
+  for (int i = 0; ok && i < min(queries, 10000); i++) {
+    vector<Interval> got(batch.intervals.begin() + batch.offsets[i],
+                         batch.intervals.begin() + batch.offsets[i + 1]);
+    ok = sameIntervals(got, tree.searchAllOverlaps(qs[i]));
+  }
+
+  cout << "========== 批量查询 (n = " << n << ", 查询 " << queries << " 次, "
+       << thread::hardware_concurrency() << " 线程) ==========" << endl;
+  cout << fixed << setprecision(2);
+  cout << "逐个查询: " << loopTime << " 毫秒 (" << queries / loopTime / 1000.0
+       << " M/s)" << endl;
+  cout << "批量查询: " << batchTime << " 毫秒 (" << queries / batchTime / 1000.0
+       << " M/s)" << endl;
+  cout << "加速比: " << loopTime / batchTime << "x, 结果"
+       << (ok ? "一致" : "不一致") << " (命中 " << loopHits << ")" << endl;
+  return ok ? 0 : 1;
+}
+
+// 基准测试：a 为 n 个预订区间、b 为 m 个维护窗口，求所有重叠对。
+// 先在小规模数据上与暴力结果逐对对照（含多片段的并行版本），
+// 再对比“对 b 建树、a 中每个区间查询一次”与扫描线连接的耗时
+int benchJoin(int n, int m) {
+  mt19937 gen(13);
+  auto makeSet = [&](int count, int range, int maxLen) {
+    vector<Interval> s(count);
+    for (Interval &x : s) {
+      x = randomInterval(gen, range, maxLen);
+    }
+    return s;
+  };
+
+  vector<Interval> smallA = makeSet(2000, 100000, 500);
+  vector<Interval> smallB = makeSet(1500, 100000, 2000);
+  smallB.push_back(Interval(5, 1)); // 空区间不参与连接
+  vector<IndexPair> expected;
+  for (int i = 0; i < (int)smallA.size(); i++) {
+    for (int j = 0; j < (int)smallB.size() - 1; j++) {
+      if (smallA[i].overlaps(smallB[j])) {
+        expected.emplace_back(i, j);
+      }
+    }
+  }
+  bool ok = true;
+  for (int threads = 0; threads <= 5; threads++) {
+    // threads 为 0 时检查单线程版本
+    vector<IndexPair> got;
+    if (threads == 0) {
+      got = joinIntervals(smallA, smallB);
+    } else {
+      got = joinIntervalsParallel(smallA, smallB, threads);
+    }
+    sort(got.begin(), got.end());
+    ok = ok && got == expected;
+  }
+
+  const int RANGE = 100000000;
+  vector<Interval> a = makeSet(n, RANGE, 1000);
+  vector<Interval> b = makeSet(m, RANGE, 5000);
+
+  long long treePairs = 0;
+  double treeTime = measureTime([&]() {
+    IntervalTree tree;
+    for (const Interval &x : b) {
+      tree.insert(x);
+    }
+    for (const Interval &x : a) {
+      treePairs += tree.searchAllOverlaps(x).size();
+    }
+  });
+  vector<IndexPair> serial, parallel;
+  double sweepTime = measureTime([&]() { serial = joinIntervals(a, b); });
+  double parallelTime =
+      measureTime([&]() { parallel = joinIntervalsParallel(a, b); });
+
+  ok = ok && (long long)serial.size() == treePairs;
+  sort(serial.begin(), serial.end());
+  sort(parallel.begin(), parallel.end());
+  ok = ok && serial == parallel;
+
+  cout << "========== 区间连接 (" << n << " x " << m << ", "
+       << thread::hardware_concurrency() << " 线程) ==========" << endl;
+  cout << fixed << setprecision(2);
+  cout << "建树 + 逐个查询: " << treeTime << " 毫秒" << endl;
+  cout << "扫描线连接:      " << sweepTime << " 毫秒 (" << treeTime / sweepTime
+       << "x)" << endl;
+  cout << "分区并行连接:    " << parallelTime << " 毫秒 ("
+       << treeTime / parallelTime << "x)" << endl;
+  cout << "重叠对 " << treePairs << " 个，结果" << (ok ? "一致" : "不一致")
+       << endl;
+  return ok ? 0 : 1;
+}
+
+// 用 insert.txt 建树，批量执行查询文件中的所有查询并输出结果
+int runQueryFile(const string &filename) {
+  IntervalTree tree;
+  vector<Interval> queries;
+  if (!tree.buildFromFile("insert.txt") || !readIntervals(filename, queries)) {
+    return 1;
+  }
+  OverlapBatchResult result = tree.searchAllOverlapsBatch(queries);
+  for (size_t q = 0; q < queries.size(); q++) {
+    cout << "查询区间: [" << queries[q].low << ", " << queries[q].high
+         << "] 找到 " << result.offsets[q + 1] - result.offsets[q]
+         << " 个重叠区间:";
+    for (size_t k = result.offsets[q]; k < result.offsets[q + 1]; k++) {
+      cout << " [" << result.intervals[k].low << ", "
+           << result.intervals[k].high << "]";
+    }
+    cout << endl;
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  // 其他模式：./interval_tree check [操作数] | bench [n] | memory [n]
+  //           | static [n] [查询数] | batch [n] [查询数] | count [n] [查询数]
+  //           | join [n] [m] | query <查询文件>
+  if (argc > 1) {
+    string mode = argv[1];
+    if (mode == "check") {
+      return runCheck(argc > 2 ? stoi(argv[2]) : 200000);
+    }
+    if (mode == "bench") {
+      return benchMixed(argc > 2 ? stoi(argv[2]) : 1000000);
+    }
+    if (mode == "memory") {
+      return benchMemory(argc > 2 ? stoi(argv[2]) : 10000000);
+    }
+    if (mode == "batch") {
+      return benchBatch(argc > 2 ? stoi(argv[2]) : 1000000,
+                        argc > 3 ? stoi(argv[3]) : 1000000);
+    }
+    if (mode == "count") {
+      return benchCount(argc > 2 ? stoi(argv[2]) : 1000000,
+                        argc > 3 ? stoi(argv[3]) : 200000);
+    }
+    if (mode == "join") {
+      return benchJoin(argc > 2 ? stoi(argv[2]) : 1000000,
+                       argc > 3 ? stoi(argv[3]) : 1000000);
+    }
+    if (mode == "query" && argc > 2) {
+      return runQueryFile(argv[2]);
+    }
+    if (mode == "static") {
+      return benchStatic(argc > 2 ? stoi(argv[2]) : 1000000,
+                         argc > 3 ? stoi(argv[3]) : 1000000);
+    }
+    cerr << "未知模式: " << mode << endl;
+    return 1;
+  }
+
   cout << "========================================" << endl;
   cout << "    区间树重叠区间查找算法实验" << endl;
   cout << "========================================" << endl << endl;
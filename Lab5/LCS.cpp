@@ -1,15 +1,100 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <random>
 #include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
 #include <vector>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LCS_HAVE_AVX2 1
+#endif
+
+#include "../common/instrument.h"
+
 using namespace std;
 
+// ==========================================
+// 公共部分: 可复用的工作空间与输出
+// ==========================================
+// 各 DP 引擎的缓冲区只增不减: 同一个工作空间反复求解不超过历史最大规模的
+// 输入时不再分配内存。取出的缓冲区内容未初始化, 边界由引擎自己写入;
+// 不能在线程间共享
+class LcsWorkspace {
+private:
+  vector<int> rowBuffer;
+  // 二维表按格子宽度各用一个有类型的缓冲区 (见 lcsStringStandard)
+  vector<uint8_t> table8;
+  vector<uint16_t> table16;
+  vector<int> table32;
+
+  vector<uint8_t> &tableBuffer(uint8_t *) { return table8; }
+  vector<uint16_t> &tableBuffer(uint16_t *) { return table16; }
+  vector<int> &tableBuffer(int *) { return table32; }
+
+public:
+  // count 个 int, 供滚动数组 / 一维压缩使用
+  int *rows(size_t count) {
+    if (rowBuffer.size() < count) {
+      rowBuffer.resize(count);
+    }
+    return rowBuffer.data();
+  }
+
+  // count 个 Cell (uint8_t / uint16_t / int), 供二维表使用。
+  // 需要扩容时顺带释放其他宽度的表, 同一时刻只保留一张大表
+  template <typename Cell> Cell *table(size_t count) {
+    vector<Cell> &buffer = tableBuffer((Cell *)nullptr);
+    if (buffer.size() < count) {
+      vector<uint8_t>().swap(table8);
+      vector<uint16_t>().swap(table16);
+      vector<int>().swap(table32);
+      buffer.resize(count);
+    }
+    return buffer.data();
+  }
+};
+
+// 输出阶段: 计算与打印分开, 各 solve 函数只负责把引擎的结果打印出来
+void printLcs(const char *title, string_view lcs) {
+  cout << "--- " << title << " ---" << endl;
+  if (lcs.empty()) {
+    cout << "LCS: 0 (不存在公共子序列)" << endl;
+  } else {
+    cout << "LCS: \"" << lcs << "\", 长度: " << lcs.length() << endl;
+  }
+  cout << endl;
+}
+
+void printLength(const char *title, int length) {
+  cout << "--- " << title << " ---" << endl;
+  cout << "LCS 长度: " << length << endl;
+  cout << endl;
+}
+
 // ==========================================
 // Part1.时间 O(mn), 空间 O(mn)
 // 功能: 求出 LCS 长度及其具体内容
 // ==========================================
-void solveStandard(string text1, string text2) {
+// 原始布局: 每行单独分配一个 vector<int>, 保留作为基准测试的对照
+string lcsStringNested(string_view text1, string_view text2) {
   int m = text1.length();
   int n = text2.length();
 
@@ -48,23 +133,146 @@ void solveStandard(string text1, string text2) {
 
   // 因为是倒着找的，需要反转字符串
   reverse(lcs.begin(), lcs.end());
+  return lcs;
+}
 
-  int length = dp[m][n];
+// 连续布局: 整张表一次分配, dp[i][j] 位于 i * (n + 1) + j。
+// 格子类型 Cell 只需容纳 min(m, n) (LCS 长度的上界), 见 lcsStringStandard。
+// dp 由调用方提供, 至少 (m + 1) * (n + 1) 个格子; 结果写入 lcs (复用其容量)
+template <typename Cell>
+void lcsStringFlat(string_view text1, string_view text2, Cell *dp,
+                   string &lcs) {
+  int m = text1.length();
+  int n = text2.length();
+  size_t stride = n + 1;
+  {
+    INSTRUMENT_SCOPE("lcs.table.fill");
+    fill(dp, dp + stride, 0);
+    for (int i = 1; i <= m; i++) {
+      const Cell *up = &dp[(i - 1) * stride];
+      Cell *row = &dp[i * stride];
+      row[0] = 0;
+      for (int j = 1; j <= n; j++) {
+        if (text1[i - 1] == text2[j - 1]) {
+          row[j] = up[j - 1] + 1;
+        } else {
+          row[j] = max(up[j], row[j - 1]);
+        }
+      }
+    }
+  }
 
-  cout << "--- 方法 1: 标准二维 DP (空间 O(mn)) ---" << endl;
-  if (length == 0) {
-    cout << "LCS: 0 (不存在公共子序列)" << endl;
+  // 回溯规则与 lcsStringNested 相同, 得到的 LCS 也相同
+  INSTRUMENT_SCOPE("lcs.table.backtrack");
+  lcs.clear();
+  int i = m, j = n;
+  while (i > 0 && j > 0) {
+    if (text1[i - 1] == text2[j - 1]) {
+      lcs += text1[i - 1];
+      i--;
+      j--;
+    } else if (dp[(i - 1) * stride + j] > dp[i * stride + j - 1]) {
+      i--;
+    } else {
+      j--;
+    }
+  }
+  reverse(lcs.begin(), lcs.end());
+}
+
+template <typename Cell>
+string lcsStringFlat(string_view text1, string_view text2) {
+  LcsWorkspace ws;
+  string lcs;
+  size_t cells = (text1.length() + 1) * (text2.length() + 1);
+  lcsStringFlat(text1, text2, ws.table<Cell>(cells), lcs);
+  return lcs;
+}
+
+// 方向矩阵: 回溯只需要知道每个格子从哪里来, 用 2 位记录
+// (0 = 左上 / 匹配, 1 = 上, 2 = 左), 每字节 4 个格子; 长度只保留两行。
+// 内存约为 int 表的 1/16, 回溯结果与 lcsStringNested 相同
+string lcsStringPacked(string_view text1, string_view text2) {
+  enum : uint8_t { DIAG = 0, UP = 1, LEFT = 2 };
+  int m = text1.length();
+  int n = text2.length();
+  size_t rowBytes = (n + 3) / 4;
+  vector<uint8_t> dir((size_t)m * rowBytes, 0);
+  vector<int> rowA(n + 1, 0), rowB(n + 1, 0);
+  int *prev = rowA.data(), *curr = rowB.data();
+
+  for (int i = 1; i <= m; i++) {
+    uint8_t *bits = &dir[(i - 1) * rowBytes];
+    char c = text1[i - 1];
+    for (int j = 1; j <= n; j++) {
+      uint8_t d;
+      if (c == text2[j - 1]) {
+        curr[j] = prev[j - 1] + 1;
+        d = DIAG;
+      } else if (prev[j] > curr[j - 1]) {
+        curr[j] = prev[j];
+        d = UP;
+      } else {
+        curr[j] = curr[j - 1];
+        d = LEFT;
+      }
+      bits[(j - 1) >> 2] |= d << (((j - 1) & 3) * 2);
+    }
+    swap(prev, curr);
+  }
+
+  string lcs;
+  int i = m, j = n;
+  while (i > 0 && j > 0) {
+    uint8_t d = (dir[(i - 1) * rowBytes + ((j - 1) >> 2)] >>
+                 (((j - 1) & 3) * 2)) & 3;
+    if (d == DIAG) {
+      lcs += text1[i - 1];
+      i--;
+      j--;
+    } else if (d == UP) {
+      i--;
+    } else {
+      j--;
+    }
+  }
+  reverse(lcs.begin(), lcs.end());
+  return lcs;
+}
+
+// 按 min(m, n) 选择最窄的格子类型, 使用连续布局; 表放在 ws 中,
+// 结果写入 lcs, 重复调用不再分配内存
+void lcsStringStandard(string_view text1, string_view text2,
+                       LcsWorkspace &ws, string &lcs) {
+  size_t bound = min(text1.length(), text2.length());
+  size_t cells = (text1.length() + 1) * (text2.length() + 1);
+  if (bound <= UINT8_MAX) {
+    lcsStringFlat(text1, text2, ws.table<uint8_t>(cells), lcs);
+  } else if (bound <= UINT16_MAX) {
+    lcsStringFlat(text1, text2, ws.table<uint16_t>(cells), lcs);
   } else {
-    cout << "LCS: \"" << lcs << "\", 长度: " << length << endl;
+    lcsStringFlat(text1, text2, ws.table<int>(cells), lcs);
   }
-  cout << endl;
+}
+
+string lcsStringStandard(string_view text1, string_view text2) {
+  LcsWorkspace ws;
+  string lcs;
+  lcsStringStandard(text1, text2, ws, lcs);
+  return lcs;
+}
+
+void solveStandard(string_view text1, string_view text2) {
+  printLcs("方法 1: 标准二维 DP (空间 O(mn))", lcsStringStandard(text1, text2));
 }
 
 // ==========================================
 // Part2.时间 O(mn), 空间 O(2 * min(m, n))
 // 功能: 仅求 LCS 长度 (使用滚动数组)
 // ==========================================
-void solveRollingArray(string text1, string text2) {
+// 原始写法: 按值传参 (复制两个串), 两行 vector<vector<int>>, 内层循环里
+// 计算 i % 2 与 (i-1) % 2; 保留作为基准测试的对照
+int lcsLengthRollingModulo(string text1, string text2) {
   // 确保 text2 是较短的那个，以保证空间复杂度为 min(m, n)
   if (text1.length() < text2.length()) {
     swap(text1, text2);
@@ -88,27 +296,57 @@ void solveRollingArray(string text1, string text2) {
       }
     }
   }
+  return dp[m % 2][n];
+}
 
-  cout << "--- 方法 2: 滚动数组 (空间 O(2*min)) ---" << endl;
-  cout << "LCS 长度: " << dp[m % 2][n] << endl;
-  cout << endl;
+// 两行放在 ws 的同一块缓冲区里, 每行算完交换 prev / curr 指针,
+// 内层循环不再取模
+int lcsLengthRolling(string_view a, string_view b, LcsWorkspace &ws) {
+  INSTRUMENT_SCOPE("lcs.rolling");
+  // 确保 b 是较短的那个，以保证空间复杂度为 min(m, n)
+  if (a.length() < b.length()) {
+    swap(a, b);
+  }
+  int m = a.length();
+  int n = b.length();
+  int *prev = ws.rows(2 * (n + 1));
+  int *curr = prev + n + 1;
+  fill(prev, prev + n + 1, 0);
+  curr[0] = 0;
+
+  for (int i = 1; i <= m; i++) {
+    char c = a[i - 1];
+    for (int j = 1; j <= n; j++) {
+      if (c == b[j - 1]) {
+        curr[j] = prev[j - 1] + 1;
+      } else {
+        curr[j] = max(prev[j], curr[j - 1]);
+      }
+    }
+    swap(prev, curr);
+  }
+  return prev[n];
+}
+
+int lcsLengthRolling(string_view a, string_view b) {
+  LcsWorkspace ws;
+  return lcsLengthRolling(a, b, ws);
+}
+
+void solveRollingArray(string_view text1, string_view text2) {
+  printLength("方法 2: 滚动数组 (空间 O(2*min))",
+              lcsLengthRolling(text1, text2));
 }
 
 // ==========================================
 // Part3.时间 O(mn), 空间 O(min(m, n))
 // 功能: 仅求 LCS 长度 (一维数组压缩)
 // ==========================================
-void solveCompressed(string text1, string text2) {
-  // 确保 inner loop 对应的 text2 是较短的
-  if (text1.length() < text2.length()) {
-    swap(text1, text2);
-  }
-  int m = text1.length();
-  int n = text2.length();
-
-  // 仅申请一行空间
-  vector<int> dp(n + 1, 0);
-
+// 一行 DP 内核: 处理完 text1 的 m 个字符后, dp[j] 为 text1 与 text2 前 j 个
+// 字符的 LCS 长度。dp 由调用方提供且须为 n + 1 个 0; 迭代器可以是反向的
+template <typename It1, typename It2>
+void lcsLastRow(It1 text1, int m, It2 text2, int n, int *dp) {
+  INSTRUMENT_SCOPE("lcs.lastRow");
   for (int i = 1; i <= m; i++) {
     int prev_diag = 0; // 记录左上角的值 (dp[i-1][j-1])
 
@@ -125,13 +363,1863 @@ void solveCompressed(string text1, string text2) {
       prev_diag = temp; // 更新左上角为当前列的旧值
     }
   }
+}
 
-  cout << "--- 方法 3: 一维压缩 (空间 O(min)) ---" << endl;
-  cout << "LCS 长度: " << dp[n] << endl;
-  cout << endl;
+int lcsLengthCompressed(string_view a, string_view b, LcsWorkspace &ws) {
+  // 确保 inner loop 对应的 text2 是较短的
+  string_view text1 = a.length() < b.length() ? b : a;
+  string_view text2 = a.length() < b.length() ? a : b;
+  int m = text1.length();
+  int n = text2.length();
+
+  // 仅使用一行空间
+  int *dp = ws.rows(n + 1);
+  fill(dp, dp + n + 1, 0);
+  lcsLastRow(text1.data(), m, text2.data(), n, dp);
+  return dp[n];
+}
+
+int lcsLengthCompressed(string_view a, string_view b) {
+  LcsWorkspace ws;
+  return lcsLengthCompressed(a, b, ws);
+}
+
+void solveCompressed(string_view text1, string_view text2) {
+  printLength("方法 3: 一维压缩 (空间 O(min))",
+              lcsLengthCompressed(text1, text2));
+}
+
+// ==========================================
+// Part4.时间 O(m * n / 64), 空间 O(σ * n / 64)
+// 功能: 仅求 LCS 长度 (位并行, Allison-Dix / Hyyrö)
+// ==========================================
+// 把较短串 (模式串, 长度 n) 的 DP 列压成 n 位的位向量 V:
+// 第 k 位为 0 表示 dp 在第 k 列相对第 k-1 列增加了 1。初始 V 全 1,
+// 对较长串的每个字符 c, 设 M 为模式串中等于 c 的位置掩码:
+//   U = V & M
+//   V = (V + U) | (V - U)       (U 是 V 的子集, 故 V - U = V & ~M)
+// 最后 LCS 长度 = V 低 n 位中 0 的个数。加法的进位在字之间传递,
+// 其余都是按位运算, 一次处理 64 列。
+class BitParallelLCS {
+private:
+  int n;                   // 模式串长度
+  int words;               // 每个位向量的字数 ceil(n / 64)
+  vector<int> slot;        // 符号 -> 掩码表中的行号, -1 表示未出现
+  vector<uint64_t> masks;  // 每个出现过的符号一行, 每行 words 个字
+  vector<uint64_t> zeroes; // 未出现符号的全 0 掩码
+
+  // 标量版本: 逐字计算, 进位用无符号溢出判断
+  void stepScalar(uint64_t *V, const uint64_t *M) const {
+    uint64_t carry = 0;
+    for (int w = 0; w < words; w++) {
+      uint64_t v = V[w];
+      uint64_t u = v & M[w];
+      uint64_t sum = v + u;
+      uint64_t out = sum < v;
+      sum += carry;
+      out |= sum < carry;
+      carry = out;
+      V[w] = sum | (v & ~M[w]);
+    }
+  }
+
+#ifdef LCS_HAVE_AVX2
+  // AVX2 版本: 一次处理 4 个字。各字先独立相加, 再用 4 位的
+  // generate (本字溢出) / propagate (本字全 1) 掩码一次算出各字的进位:
+  //   carryIn = (((g << 1) | carry) + p) ^ p
+  // 第 4 位即向下一组的进位。剩余不足 4 个字的部分走标量逻辑。
+  __attribute__((target("avx2"))) void stepAVX2(uint64_t *V,
+                                                const uint64_t *M) const {
+    const __m256i sign = _mm256_set1_epi64x((long long)(1ULL << 63));
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    const __m256i shifts = _mm256_setr_epi64x(0, 1, 2, 3);
+    const __m256i one = _mm256_set1_epi64x(1);
+    unsigned carry = 0;
+    int w = 0;
+    for (; w + 4 <= words; w += 4) {
+      __m256i v = _mm256_loadu_si256((const __m256i *)(V + w));
+      __m256i m = _mm256_loadu_si256((const __m256i *)(M + w));
+      __m256i u = _mm256_and_si256(v, m);
+      __m256i sum = _mm256_add_epi64(v, u);
+      // 无符号比较 sum < v: 两边翻转符号位后做有符号比较
+      __m256i gen = _mm256_cmpgt_epi64(_mm256_xor_si256(v, sign),
+                                       _mm256_xor_si256(sum, sign));
+      __m256i prop = _mm256_cmpeq_epi64(sum, ones);
+      unsigned g = _mm256_movemask_pd(_mm256_castsi256_pd(gen));
+      unsigned p = _mm256_movemask_pd(_mm256_castsi256_pd(prop));
+      unsigned t = ((g << 1) | carry) + p;
+      unsigned carryIn = (t ^ p) & 0xF;
+      carry = (t >> 4) & 1;
+      __m256i cin = _mm256_and_si256(
+          _mm256_srlv_epi64(_mm256_set1_epi64x(carryIn), shifts), one);
+      sum = _mm256_add_epi64(sum, cin);
+      _mm256_storeu_si256((__m256i *)(V + w),
+                          _mm256_or_si256(sum, _mm256_andnot_si256(m, v)));
+    }
+    for (; w < words; w++) {
+      uint64_t v = V[w];
+      uint64_t u = v & M[w];
+      uint64_t sum = v + u;
+      uint64_t out = sum < v;
+      sum += carry;
+      out |= sum < carry;
+      carry = out;
+      V[w] = sum | (v & ~M[w]);
+    }
+  }
+#endif
+
+public:
+  // 预处理模式串: 为每个出现过的字符建立位置掩码
+  explicit BitParallelLCS(string_view pattern)
+      : BitParallelLCS((const unsigned char *)pattern.data(), pattern.length(),
+                       256) {}
+
+  // 一般的符号序列 (字节、行号等), 符号取值在 [0, alphabet) 内
+  template <typename T>
+  BitParallelLCS(const T *pattern, int len, int alphabet)
+      : n(len), words((n + 63) / 64), slot(alphabet, -1) {
+    for (int k = 0; k < n; k++) {
+      size_t c = pattern[k];
+      if (slot[c] < 0) {
+        slot[c] = masks.size() / words;
+        masks.resize(masks.size() + words, 0);
+      }
+      masks[(size_t)slot[c] * words + k / 64] |= 1ULL << (k % 64);
+    }
+    zeroes.assign(words, 0);
+  }
+
+  // 当前机器是否可用 AVX2 版本
+  static bool simdAvailable() {
+#ifdef LCS_HAVE_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+  }
+
+  // 模式串与 text 的 LCS 长度; useSimd 为 false 时强制使用标量版本
+  int length(string_view text, bool useSimd = true) const {
+    return length((const unsigned char *)text.data(), text.length(), useSimd);
+  }
+
+  // 模式串与符号序列 text[0, len) 的 LCS 长度, 超出字母表的符号视为不匹配
+  template <typename T>
+  int length(const T *text, int len, bool useSimd = true) const {
+    vector<uint64_t> V;
+    return length(text, len, V, useSimd);
+  }
+
+  // 同上, 位向量放在调用者提供的 V 中; 批量打分时每个线程复用一份,
+  // 重复调用不再分配内存
+  template <typename T>
+  int length(const T *text, int len, vector<uint64_t> &V,
+             bool useSimd = true) const {
+    if (n == 0) {
+      return 0;
+    }
+    INSTRUMENT_SCOPE("lcs.bitParallel");
+    V.assign(words, ~0ULL);
+    bool simd = useSimd && words >= 4 && simdAvailable();
+    for (int k = 0; k < len; k++) {
+      size_t c = text[k];
+      const uint64_t *M = c >= slot.size() || slot[c] < 0
+                              ? zeroes.data()
+                              : &masks[(size_t)slot[c] * words];
+#ifdef LCS_HAVE_AVX2
+      if (simd) {
+        stepAVX2(V.data(), M);
+        continue;
+      }
+#endif
+      stepScalar(V.data(), M);
+    }
+    // 只统计低 n 位中的 0, 最后一个字高于 n 的位不计
+    int zeros = 0;
+    for (int w = 0; w < words; w++) {
+      uint64_t valid = (w == words - 1 && n % 64 != 0)
+                           ? (1ULL << (n % 64)) - 1
+                           : ~0ULL;
+      zeros += __builtin_popcountll(~V[w] & valid);
+    }
+    return zeros;
+  }
+};
+
+// 位并行求 LCS 长度, 以较短串为模式串
+int lcsLengthBitParallel(string_view a, string_view b, bool useSimd = true) {
+  string_view text = a.length() < b.length() ? b : a;
+  string_view pattern = a.length() < b.length() ? a : b;
+  return BitParallelLCS(pattern).length(text, useSimd);
+}
+
+void solveBitParallel(string_view text1, string_view text2) {
+  printLength("方法 4: 位并行 (空间 O(min / 64))",
+              lcsLengthBitParallel(text1, text2));
+}
+
+// ==========================================
+// Part5.时间 O(mn), 空间 O(min(m, n))
+// 功能: 求出 LCS 具体内容 (Hirschberg 分治)
+// ==========================================
+// 把 a 从中间切成两半: 上半用一行内核正向求出 a[0, mid) 与 b 每个前缀的
+// LCS 长度, 下半对两串反向求出 a[mid, m) 与 b 每个后缀的 LCS 长度,
+// 两者之和最大的位置 k 就是最优路径穿过中间行的列。于是问题分成
+// (a[0, mid), b[0, k)) 与 (a[mid, m), b[k, n)) 两个独立的子问题, 各自的
+// LCS 长度已知, 结果可以直接写到输出的对应区段, 两半可以并行求解。
+// 子问题足够小时改用标准二维 DP 回溯。
+const int HIRSCHBERG_SMALL = 1 << 16;    // 小于该格子数时直接用二维 DP
+const long long PARALLEL_CELLS = 1 << 22; // 大于该格子数时才开线程
+
+// LCS 中一对匹配的位置 (在 a 中的下标, 在 b 中的下标)
+using MatchPair = pair<int, int>;
+
+// 小规模子问题: 连续二维表 + 回溯 (规则同 lcsStringNested), 把匹配位置
+// 加上偏移 aOff / bOff 后按顺序写入 out
+template <typename T>
+void lcsMatchesSmall(const T *a, int m, const T *b, int n, int aOff, int bOff,
+                     MatchPair *out) {
+  size_t stride = n + 1;
+  vector<int> dp((size_t)(m + 1) * stride, 0);
+  for (int i = 1; i <= m; i++) {
+    const int *up = &dp[(i - 1) * stride];
+    int *row = &dp[i * stride];
+    for (int j = 1; j <= n; j++) {
+      row[j] = a[i - 1] == b[j - 1] ? up[j - 1] + 1 : max(up[j], row[j - 1]);
+    }
+  }
+  int k = dp[m * stride + n];
+  int i = m, j = n;
+  while (i > 0 && j > 0) {
+    if (a[i - 1] == b[j - 1]) {
+      out[--k] = MatchPair(aOff + i - 1, bOff + j - 1);
+      i--;
+      j--;
+    } else if (dp[(i - 1) * stride + j] > dp[i * stride + j - 1]) {
+      i--;
+    } else {
+      j--;
+    }
+  }
+}
+
+// 一次分割的结果: 最优路径在中间行 mid = m / 2 处穿过的列, 上半
+// (a[0, mid), b[0, column)) 的 LCS 长度, 以及整段的 LCS 长度
+struct HirschbergSplit {
+  int column;
+  int leftLength;
+  int length;
+};
+
+template <typename T>
+HirschbergSplit hirschbergSplit(const T *a, int m, const T *b, int n,
+                                bool parallel) {
+  int mid = m / 2;
+  vector<int> forward(n + 1, 0), backward(n + 1, 0);
+  auto top = [&]() { lcsLastRow(a, mid, b, n, forward.data()); };
+  auto bottom = [&]() {
+    lcsLastRow(make_reverse_iterator(a + m), m - mid,
+               make_reverse_iterator(b + n), n, backward.data());
+  };
+  if (parallel) {
+    auto f = async(launch::async, top);
+    bottom();
+    f.wait();
+  } else {
+    top();
+    bottom();
+  }
+
+  HirschbergSplit split = {0, 0, -1};
+  for (int j = 0; j <= n; j++) {
+    if (forward[j] + backward[n - j] > split.length) {
+      split.length = forward[j] + backward[n - j];
+      split.column = j;
+    }
+  }
+  split.leftLength = forward[split.column];
+  // 返回时释放两行, 递归的每层只保留 O(n) 的工作空间
+  return split;
+}
+
+// 是否属于直接求解的小规模子问题 (见 hirschberg)
+bool hirschbergBaseCase(int m, int n) {
+  return m <= 1 || n == 0 || (long long)(m + 1) * (n + 1) <= HIRSCHBERG_SMALL;
+}
+
+template <typename T>
+void hirschberg(const T *a, int m, const T *b, int n, int aOff, int bOff,
+                MatchPair *out, int parallelDepth);
+
+// 按分割结果分别求解上下两半, 上半的匹配写到 out, 下半的接在其后
+template <typename T>
+void hirschbergHalves(const T *a, int m, const T *b, int n,
+                      const HirschbergSplit &split, int aOff, int bOff,
+                      MatchPair *out, int parallelDepth) {
+  int mid = m / 2, k = split.column;
+  bool parallel = parallelDepth > 0 && (long long)m * n >= PARALLEL_CELLS;
+  auto left = [&]() {
+    hirschberg(a, mid, b, k, aOff, bOff, out, parallelDepth - 1);
+  };
+  auto right = [&]() {
+    hirschberg(a + mid, m - mid, b + k, n - k, aOff + mid, bOff + k,
+               out + split.leftLength, parallelDepth - 1);
+  };
+  if (parallel) {
+    auto f = async(launch::async, left);
+    right();
+    f.wait();
+  } else {
+    left();
+    right();
+  }
+}
+
+template <typename T>
+void hirschberg(const T *a, int m, const T *b, int n, int aOff, int bOff,
+                MatchPair *out, int parallelDepth) {
+  if (m == 0 || n == 0) {
+    return;
+  }
+  if (m == 1) {
+    const T *hit = find(b, b + n, a[0]);
+    if (hit != b + n) {
+      *out = MatchPair(aOff, bOff + (hit - b));
+    }
+    return;
+  }
+  if (hirschbergBaseCase(m, n)) {
+    lcsMatchesSmall(a, m, b, n, aOff, bOff, out);
+    return;
+  }
+  bool parallel = parallelDepth > 0 && (long long)m * n >= PARALLEL_CELLS;
+  HirschbergSplit split = hirschbergSplit(a, m, b, n, parallel);
+  hirschbergHalves(a, m, b, n, split, aOff, bOff, out, parallelDepth);
+}
+
+// 线性空间求 a[0, m) 与 b[0, n) 的一个 LCS, 返回按顺序排列的匹配位置。
+// 输出大小即 LCS 总长, 取自顶层分割本来就要算的两行, 不另求一遍,
+// 也不建与字母表大小相关的表 (按行比较时符号数可能接近行数);
+// threads 为 0 时取 CPU 核数, 递归的前 log2(threads) 层并行
+template <typename T>
+vector<MatchPair> lcsMatches(const T *a, int m, const T *b, int n,
+                             int threads = 0) {
+  // 以较短的序列作为行方向, 工作空间为 O(min(m, n))
+  bool swapped = m < n;
+  if (swapped) {
+    swap(a, b);
+    swap(m, n);
+  }
+  if (threads <= 0) {
+    threads = max(1u, thread::hardware_concurrency());
+  }
+  int parallelDepth = 0;
+  while ((1 << parallelDepth) < threads) {
+    parallelDepth++;
+  }
+  vector<MatchPair> matches;
+  if (hirschbergBaseCase(m, n)) {
+    vector<int> row(n + 1, 0);
+    lcsLastRow(a, m, b, n, row.data());
+    matches.resize(row[n]);
+    hirschberg(a, m, b, n, 0, 0, matches.data(), parallelDepth);
+  } else {
+    bool parallel = parallelDepth > 0 && (long long)m * n >= PARALLEL_CELLS;
+    HirschbergSplit split = hirschbergSplit(a, m, b, n, parallel);
+    matches.resize(split.length);
+    hirschbergHalves(a, m, b, n, split, 0, 0, matches.data(), parallelDepth);
+  }
+  if (swapped) {
+    for (MatchPair &p : matches) {
+      swap(p.first, p.second);
+    }
+  }
+  return matches;
+}
+
+// 线性空间求 LCS 字符串
+string lcsStringHirschberg(string_view a, string_view b, int threads = 0) {
+  vector<MatchPair> matches =
+      lcsMatches((const unsigned char *)a.data(), a.length(),
+                 (const unsigned char *)b.data(), b.length(), threads);
+  string lcs(matches.size(), '\0');
+  for (size_t k = 0; k < matches.size(); k++) {
+    lcs[k] = a[matches[k].first];
+  }
+  return lcs;
+}
+
+void solveHirschberg(string_view text1, string_view text2) {
+  printLcs("方法 5: Hirschberg 分治 (空间 O(min))",
+           lcsStringHirschberg(text1, text2));
+}
+
+// ==========================================
+// Part6.时间 O(mn / p), 空间 O(m + n)
+// 功能: 仅求 LCS 长度 (分块反对角线波前, 多线程 + SIMD)
+// ==========================================
+// 逐行填表时每个格子都依赖左边刚算出的格子, 既不能向量化也不能并行。
+// 同一条反对角线 (i + j = d) 上的格子却互不依赖:
+//   dp[i][j] = a[i] == b[j] ? D(d-2)[i-1] + 1 : max(D(d-1)[i-1], D(d-1)[i])
+// 其中 D(d) 表示第 d 条反对角线, 按行号 i 存放。于是:
+// 1. 把 DP 表切成 WAVEFRONT_TILE × WAVEFRONT_TILE 的块, 块 (bi, bj) 只依赖
+//    上方和左方的块, 同一条块反对角线上的块分给各线程并行计算,
+//    每条块反对角线结束时所有线程同步一次;
+// 2. 块内沿反对角线计算, 上式对 i 连续, 一次处理 8 个格子 (AVX2,
+//    运行时检测, 不可用时走标量循环); b 在块内倒序存放, 使 b[j] = b[d - i]
+//    的访问也随 i 连续。
+// 块之间只通过边界交换数据: H[j] 为 j 列在最近一个块底部的值,
+// V[i] 为 i 行在最近一个块右侧的值, 块在原位读入上 / 左边界、写出下 / 右
+// 边界 (读第 k 个边界值总是早于写第 k 个结果值)。左上角的值由左上方的块
+// 算完后存入 corners。
+// 块边长 1024 时, 三条反对角线 + 两串字符 + 边界约 36 KB,
+// 放得进 L1 / L2, 而每条块反对角线上的计算量又足以摊薄同步开销。
+const int WAVEFRONT_TILE = 1024;
+
+// 每个线程的块内工作区, 只分配一次
+struct WavefrontWorkspace {
+  vector<int> diag[3];   // 三条滚动的反对角线, 按行号 i 存放
+  vector<int> rowChars;  // 块内 a 的字符 (1 起始)
+  vector<int> colChars;  // 块内 b 的字符, 倒序存放 (1 起始)
+
+  WavefrontWorkspace() {
+    for (vector<int> &d : diag) {
+      d.assign(WAVEFRONT_TILE + 1, 0);
+    }
+    rowChars.assign(WAVEFRONT_TILE + 1, 0);
+    colChars.assign(WAVEFRONT_TILE + 2, 0);
+  }
+};
+
+// 计算一条反对角线上行号为 [lo, hi] 的格子 (标量版本)。第 i 行的格子
+// 对应 b 的字符 pb[i + shift]; 偏移在访问时才加上, 不构造指向数组之外的指针
+void wavefrontDiagonal(const int *pa, const int *pb, int shift, const int *up,
+                       const int *upLeft, int *out, int lo, int hi) {
+  for (int i = lo; i <= hi; i++) {
+    int skip = max(up[i - 1], up[i]);
+    int take = upLeft[i - 1] + 1;
+    out[i] = pa[i] == pb[i + shift] ? take : skip;
+  }
+}
+
+#ifdef LCS_HAVE_AVX2
+// 同上, AVX2 版本: 字符相等的格子取左上 + 1, 否则取上、左的较大者
+__attribute__((target("avx2"))) void
+wavefrontDiagonalAVX2(const int *pa, const int *pb, int shift, const int *up,
+                      const int *upLeft, int *out, int lo, int hi) {
+  const __m256i one = _mm256_set1_epi32(1);
+  int i = lo;
+  for (; i + 7 <= hi; i += 8) {
+    __m256i skip =
+        _mm256_max_epi32(_mm256_loadu_si256((const __m256i *)(up + i - 1)),
+                         _mm256_loadu_si256((const __m256i *)(up + i)));
+    __m256i take = _mm256_add_epi32(
+        _mm256_loadu_si256((const __m256i *)(upLeft + i - 1)), one);
+    __m256i chars = _mm256_loadu_si256((const __m256i *)(pb + (i + shift)));
+    __m256i eq = _mm256_cmpeq_epi32(
+        _mm256_loadu_si256((const __m256i *)(pa + i)), chars);
+    _mm256_storeu_si256((__m256i *)(out + i),
+                        _mm256_blendv_epi8(skip, take, eq));
+  }
+  wavefrontDiagonal(pa, pb, shift, up, upLeft, out, i, hi);
+}
+#endif
+
+// 计算一个 rows × cols 的块。a / b 指向块对应的字符, top[j - 1] / left[i - 1]
+// 为上 / 左边界, 计算结束后分别被改写为块的最下一行 / 最右一列;
+// corner 为左上角外侧的值; simd 为 true 时使用 AVX2。返回块右下角的值
+int wavefrontTile(const char *a, const char *b, int rows, int cols, int corner,
+                  int *top, int *left, WavefrontWorkspace &ws, bool simd) {
+  INSTRUMENT_SCOPE("lcs.wavefrontTile");
+  int *pa = ws.rowChars.data();
+  int *pb = ws.colChars.data();
+  for (int i = 1; i <= rows; i++) {
+    pa[i] = (unsigned char)a[i - 1];
+  }
+  for (int k = 1; k <= cols; k++) {
+    pb[k] = (unsigned char)b[cols - k];
+  }
+
+  int *prev2 = ws.diag[0].data(); // 第 d - 2 条
+  int *prev1 = ws.diag[1].data(); // 第 d - 1 条
+  int *cur = ws.diag[2].data();   // 第 d 条
+  prev2[0] = corner;
+  prev1[0] = top[0];
+  prev1[1] = left[0];
+  for (int d = 2; d <= rows + cols; d++) {
+    if (d <= cols) {
+      cur[0] = top[d - 1];
+    }
+    if (d <= rows) {
+      cur[d] = left[d - 1];
+    }
+    int lo = max(1, d - cols), hi = min(rows, d - 1);
+    int shift = cols + 1 - d; // 格子 (i, d - i) 的 b 字符为 pb[i + shift]
+#ifdef LCS_HAVE_AVX2
+    if (simd) {
+      wavefrontDiagonalAVX2(pa, pb, shift, prev1, prev2, cur, lo, hi);
+    } else {
+      wavefrontDiagonal(pa, pb, shift, prev1, prev2, cur, lo, hi);
+    }
+#else
+    (void)simd;
+    wavefrontDiagonal(pa, pb, shift, prev1, prev2, cur, lo, hi);
+#endif
+    if (d > rows) {
+      top[d - rows - 1] = cur[rows]; // 最下一行的第 d - rows 列
+    }
+    if (d > cols) {
+      left[d - cols - 1] = cur[d - cols]; // 最右一列的第 d - cols 行
+    }
+    int *t = prev2;
+    prev2 = prev1;
+    prev1 = cur;
+    cur = t;
+  }
+  return prev1[rows];
+}
+
+// 简单的线程屏障: 所有线程都到达后一起放行
+class Barrier {
+private:
+  mutex lock;
+  condition_variable cv;
+  int total;
+  int waiting = 0;
+  long long generation = 0;
+
+public:
+  explicit Barrier(int n) : total(n) {}
+
+  void arriveAndWait() {
+    unique_lock<mutex> guard(lock);
+    long long gen = generation;
+    if (++waiting == total) {
+      waiting = 0;
+      generation++;
+      cv.notify_all();
+    } else {
+      cv.wait(guard, [&]() { return generation != gen; });
+    }
+  }
+};
+
+// 分块波前求 LCS 长度; threads 为 0 时取 CPU 核数,
+// useSimd 为 false 时强制使用标量版本
+int lcsLengthWavefront(string_view a, string_view b, int threads = 0,
+                       bool useSimd = true) {
+  int m = a.length(), n = b.length();
+  if (m == 0 || n == 0) {
+    return 0;
+  }
+  if (threads <= 0) {
+    threads = max(1u, thread::hardware_concurrency());
+  }
+  int R = (m + WAVEFRONT_TILE - 1) / WAVEFRONT_TILE; // 块的行数
+  int C = (n + WAVEFRONT_TILE - 1) / WAVEFRONT_TILE; // 块的列数
+  threads = min(threads, min(R, C));
+
+  vector<int> H(n, 0), V(m, 0);
+  vector<int> corners((size_t)R * C, 0);
+  Barrier barrier(threads);
+  bool simd = useSimd && BitParallelLCS::simdAvailable();
+
+  auto worker = [&](int t) {
+    WavefrontWorkspace ws;
+    for (int D = 0; D <= R + C - 2; D++) {
+      int first = max(0, D - (C - 1)), last = min(R - 1, D);
+      for (int bi = first + t; bi <= last; bi += threads) {
+        int bj = D - bi;
+        int i0 = bi * WAVEFRONT_TILE, j0 = bj * WAVEFRONT_TILE;
+        int rows = min(WAVEFRONT_TILE, m - i0);
+        int cols = min(WAVEFRONT_TILE, n - j0);
+        int corner = corners[(size_t)bi * C + bj];
+        int bottomRight = wavefrontTile(a.data() + i0, b.data() + j0, rows,
+                                        cols, corner, &H[j0], &V[i0], ws,
+                                        simd);
+        if (bi + 1 < R && bj + 1 < C) {
+          corners[(size_t)(bi + 1) * C + bj + 1] = bottomRight;
+        }
+      }
+      barrier.arriveAndWait();
+    }
+  };
+
+  vector<thread> pool;
+  for (int t = 1; t < threads; t++) {
+    pool.emplace_back(worker, t);
+  }
+  worker(0);
+  for (thread &th : pool) {
+    th.join();
+  }
+  return H[n - 1];
+}
+
+void solveWavefront(string_view text1, string_view text2) {
+  printLength("方法 6: 分块波前 (空间 O(m + n))",
+              lcsLengthWavefront(text1, text2));
+}
+
+// 计时辅助：返回 func 的运行时间（毫秒）, 见 common/instrument.h
+using instrument::measureTime;
+
+// 生成长度为 len 的随机串, 字符取自 'a' 开始的 sigma 个字母
+string randomText(mt19937 &gen, int len, int sigma) {
+  uniform_int_distribution<int> dis(0, sigma - 1);
+  string s(len, 'a');
+  for (char &c : s) {
+    c = 'a' + dis(gen);
+  }
+  return s;
+}
+
+// ==========================================
+// Part7.时间 O((m + n) * d), 空间 O(m + n)
+// 功能: 相似输入的 LCS (Myers 差分算法, d 为最少插入 + 删除次数)
+// ==========================================
+// 在编辑图上, 第 k 条对角线 (x - y = k) 上用 d 次编辑能走到的最远点为
+// V[k]: 先从 k - 1 (删除) 或 k + 1 (插入) 走一步, 再沿相等的字符 "滑行"。
+// 走到 (m, n) 时的 d 即编辑距离, LCS = (m + n - d) / 2。
+// 只对近似相同的输入划算, 所以调用方给出上限 maxD, 超出即放弃。
+template <typename T>
+int myersDistance(const T *a, int m, const T *b, int n, int maxD) {
+  maxD = min(maxD, m + n);
+  vector<int> V(2 * maxD + 3, 0);
+  int *v = V.data() + maxD + 1; // v[k], k ∈ [-maxD - 1, maxD + 1]
+  for (int d = 0; d <= maxD; d++) {
+    for (int k = -d; k <= d; k += 2) {
+      int x = (k == -d || (k != d && v[k - 1] < v[k + 1])) ? v[k + 1]
+                                                           : v[k - 1] + 1;
+      int y = x - k;
+      while (x < m && y < n && a[x] == b[y]) {
+        x++;
+        y++;
+      }
+      v[k] = x;
+      if (x >= m && y >= n) {
+        return d;
+      }
+    }
+  }
+  return -1;
+}
+
+// 线性空间的 Myers: 同时从两端搜索, 找到正反两条路径相遇的
+// "中间蛇形" (一段相等字符的对角线), 把它输出为匹配, 两侧递归。
+// vf / vb 为正向 / 反向的 V 数组, 由顶层按 m + n 分配, 递归时复用
+template <typename T>
+void myersMatches(const T *a, int m, const T *b, int n, int aOff, int bOff,
+                  vector<MatchPair> &out, int *vf, int *vb) {
+  // 去掉公共前缀与后缀, 前缀的匹配先输出, 后缀的最后输出
+  int prefix = 0;
+  while (prefix < m && prefix < n && a[prefix] == b[prefix]) {
+    out.push_back(MatchPair(aOff + prefix, bOff + prefix));
+    prefix++;
+  }
+  a += prefix, b += prefix, m -= prefix, n -= prefix;
+  aOff += prefix, bOff += prefix;
+  int suffix = 0;
+  while (suffix < m && suffix < n && a[m - 1 - suffix] == b[n - 1 - suffix]) {
+    suffix++;
+  }
+  m -= suffix, n -= suffix;
+
+  if (m > 0 && n > 0) {
+    // 反向搜索在 (m - x, n - y) 坐标下进行, 其对角线 c 对应正向的
+    // k = delta - c; 正向在 k 上到达的 x 加上反向在 c 上到达的
+    // x 不小于 m 时两条路径重叠
+    int delta = m - n;
+    bool odd = delta & 1;
+    int maxD = (m + n + 1) / 2;
+    fill(vf, vf + 2 * maxD + 3, 0);
+    fill(vb, vb + 2 * maxD + 3, 0);
+    int *f = vf + maxD + 1, *r = vb + maxD + 1;
+    int sx = 0, sy = 0, ex = 0, ey = 0; // 中间蛇形的起点与终点 (正向坐标)
+    bool found = false;
+    for (int d = 0; d <= maxD && !found; d++) {
+      for (int k = -d; k <= d && !found; k += 2) {
+        int x = (k == -d || (k != d && f[k - 1] < f[k + 1])) ? f[k + 1]
+                                                             : f[k - 1] + 1;
+        int y = x - k;
+        int x0 = x, y0 = y;
+        while (x < m && y < n && a[x] == b[y]) {
+          x++;
+          y++;
+        }
+        f[k] = x;
+        int c = delta - k;
+        if (odd && c >= -(d - 1) && c <= d - 1 && f[k] + r[c] >= m) {
+          sx = x0, sy = y0, ex = x, ey = y;
+          found = true;
+        }
+      }
+      for (int c = -d; c <= d && !found; c += 2) {
+        int x = (c == -d || (c != d && r[c - 1] < r[c + 1])) ? r[c + 1]
+                                                             : r[c - 1] + 1;
+        int y = x - c;
+        int x0 = x, y0 = y;
+        while (x < m && y < n && a[m - 1 - x] == b[n - 1 - y]) {
+          x++;
+          y++;
+        }
+        r[c] = x;
+        int k = delta - c;
+        if (!odd && k >= -d && k <= d && f[k] + r[c] >= m) {
+          sx = m - x, sy = n - y, ex = m - x0, ey = n - y0;
+          found = true;
+        }
+      }
+    }
+    myersMatches(a, sx, b, sy, aOff, bOff, out, vf, vb);
+    for (int k = 0; k < ex - sx; k++) {
+      out.push_back(MatchPair(aOff + sx + k, bOff + sy + k));
+    }
+    myersMatches(a + ex, m - ex, b + ey, n - ey, aOff + ex, bOff + ey, out,
+                 vf, vb);
+  }
+
+  for (int k = 0; k < suffix; k++) {
+    out.push_back(MatchPair(aOff + m + k, bOff + n + k));
+  }
+}
+
+// 自动选择引擎时 Myers 的编辑次数上限: 位并行的代价约为 m * n / 64 次
+// 字运算, Myers 约为 d² 次对角线延伸, 二者相当时 d ≈ sqrt(m * n / 64)。
+// 超过上限说明两者差别较大, 改用与 d 无关的引擎。MYERS_BUDGET 由
+// crossover 基准测试标定: n = 20000 时 Myers 与位并行在 d ≈ 1500 处持平
+const double MYERS_BUDGET = 0.6;
+
+int myersLimit(int m, int n) {
+  return (int)(MYERS_BUDGET * sqrt((double)m * n / 64)) + 16;
+}
+
+// 位并行引擎的掩码表为 (模式串中不同符号数) × ceil(n / 64) 个字。字节序列
+// 最多 256 行, 即每个符号 4 个字; 符号是行号时不同符号数可能接近 n,
+// 掩码表会膨胀到 O(n² / 64)。表不超过 4n 个字或 BIT_PARALLEL_MASK_WORDS
+// (32 MB) 时才用位并行, 否则改用一行 DP
+const size_t BIT_PARALLEL_MASK_WORDS = 1 << 22;
+
+template <typename T>
+bool bitParallelFits(const T *pattern, int n, int alphabet) {
+  size_t words = (n + 63) / 64;
+  size_t limit = max(BIT_PARALLEL_MASK_WORDS, (size_t)n * 4);
+  vector<bool> seen(alphabet, false);
+  size_t distinct = 0;
+  for (int k = 0; k < n; k++) {
+    if (!seen[pattern[k]]) {
+      seen[pattern[k]] = true;
+      if (++distinct * words > limit) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// 自动选择引擎求 LCS 长度: 先去掉公共前缀后缀; 长度差已超过上限时
+// 直接用位并行, 否则先试探性地跑有上限的 Myers, 超限再回退到位并行。
+// 试探的代价不超过回退的代价, 所以差别大的输入最多慢一倍左右。
+// 位并行的掩码表过大 (见 bitParallelFits) 时回退到一行 DP。
+// engine 非空时写入实际使用的引擎名
+template <typename T>
+int lcsLengthAuto(const T *a, int m, const T *b, int n, int alphabet,
+                  const char **engine = nullptr) {
+  int prefix = 0, suffix = 0;
+  while (prefix < m && prefix < n && a[prefix] == b[prefix]) {
+    prefix++;
+  }
+  while (suffix < m - prefix && suffix < n - prefix &&
+         a[m - 1 - suffix] == b[n - 1 - suffix]) {
+    suffix++;
+  }
+  a += prefix, b += prefix;
+  m -= prefix + suffix, n -= prefix + suffix;
+  int common = prefix + suffix;
+
+  int limit = myersLimit(m, n);
+  if (abs(m - n) <= limit) {
+    int d = myersDistance(a, m, b, n, limit);
+    if (d >= 0) {
+      if (engine) {
+        *engine = "Myers";
+      }
+      return common + (m + n - d) / 2;
+    }
+  }
+  if (m < n) {
+    swap(a, b);
+    swap(m, n);
+  }
+  if (bitParallelFits(b, n, alphabet)) {
+    if (engine) {
+      *engine = "位并行";
+    }
+    return common + BitParallelLCS(b, n, alphabet).length(a, m);
+  }
+  if (engine) {
+    *engine = "一行 DP";
+  }
+  vector<int> row(n + 1, 0);
+  lcsLastRow(a, m, b, n, row.data());
+  return common + row[n];
+}
+
+int lcsLengthAuto(string_view a, string_view b,
+                  const char **engine = nullptr) {
+  return lcsLengthAuto((const unsigned char *)a.data(), a.length(),
+                       (const unsigned char *)b.data(), b.length(), 256,
+                       engine);
+}
+
+// ==========================================
+// Part8.文件比较 (mmap + 字节 / 行符号序列 + 编辑脚本)
+// ==========================================
+// 只读映射一个文件, 析构时解除映射
+class MappedFile {
+private:
+  void *base = MAP_FAILED;
+  size_t length = 0;
+
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile() {
+    if (base != MAP_FAILED) {
+      munmap(base, length);
+    }
+  }
+
+  bool open(const string &filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      cerr << "无法打开文件: " << filename << endl;
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      cerr << "无法读取文件信息: " << filename << endl;
+      close(fd);
+      return false;
+    }
+    length = st.st_size;
+    if (length > 0) {
+      base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (length > 0 && base == MAP_FAILED) {
+      cerr << "mmap 失败: " << filename << endl;
+      return false;
+    }
+    if (length > 0) {
+      madvise(base, length, MADV_SEQUENTIAL);
+    }
+    return true;
+  }
+
+  const unsigned char *data() const {
+    return length > 0 ? (const unsigned char *)base : nullptr;
+  }
+  size_t size() const { return length; }
+};
+
+// 按 '\n' 切行, 每行 (不含换行符) 通过 dict 映射为稠密的整数编号,
+// 内容相同的行编号相同。lines 记录每行在映射内存中的位置, 不拷贝内容
+void tokenizeLines(const MappedFile &file,
+                   unordered_map<string_view, int> &dict, vector<int> &ids,
+                   vector<string_view> &lines) {
+  const char *p = (const char *)file.data();
+  const char *end = p + file.size();
+  while (p < end) {
+    const char *eol = (const char *)memchr(p, '\n', end - p);
+    const char *next = eol ? eol + 1 : end;
+    string_view line(p, (eol ? eol : end) - p);
+    auto it = dict.emplace(line, (int)dict.size()).first;
+    ids.push_back(it->second);
+    lines.push_back(line);
+    p = next;
+  }
+}
+
+// 编辑脚本中的一段改动: a[aPos, aPos + aLen) 被替换为 b[bPos, bPos + bLen)
+struct Hunk {
+  int aPos, aLen;
+  int bPos, bLen;
+};
+
+struct DiffResult {
+  int prefix = 0; // 公共前缀长度
+  int suffix = 0; // 公共后缀长度
+  int lcs = 0;    // LCS 长度 (含前后缀)
+  const char *engine = "";
+  vector<Hunk> hunks;
+};
+
+// 比较两个符号序列: 先去掉公共前缀与后缀, 中间部分在编辑次数不超过
+// myersLimit 时用线性空间 Myers, 否则用 lcsMatches (Hirschberg) 求 LCS,
+// 再把相邻两个匹配之间的空档整理成编辑脚本
+template <typename T>
+DiffResult diffSequences(const T *a, int m, const T *b, int n) {
+  DiffResult result;
+  while (result.prefix < m && result.prefix < n &&
+         a[result.prefix] == b[result.prefix]) {
+    result.prefix++;
+  }
+  while (result.suffix < m - result.prefix &&
+         result.suffix < n - result.prefix &&
+         a[m - 1 - result.suffix] == b[n - 1 - result.suffix]) {
+    result.suffix++;
+  }
+  int p = result.prefix;
+  int mm = m - p - result.suffix, nn = n - p - result.suffix;
+  int limit = myersLimit(mm, nn);
+  vector<MatchPair> matches;
+  if (abs(mm - nn) <= limit &&
+      myersDistance(a + p, mm, b + p, nn, limit) >= 0) {
+    vector<int> vf(mm + nn + 4), vb(mm + nn + 4);
+    myersMatches(a + p, mm, b + p, nn, 0, 0, matches, vf.data(), vb.data());
+    result.engine = "Myers";
+  } else {
+    matches = lcsMatches(a + p, mm, b + p, nn);
+    result.engine = "Hirschberg";
+  }
+  result.lcs = p + matches.size() + result.suffix;
+
+  int i = p, j = p;
+  auto gap = [&](int ai, int bj) {
+    if (i < ai || j < bj) {
+      result.hunks.push_back({i, ai - i, j, bj - j});
+    }
+    i = ai + 1;
+    j = bj + 1;
+  };
+  for (const MatchPair &match : matches) {
+    gap(p + match.first, p + match.second);
+  }
+  gap(m - result.suffix, n - result.suffix);
+  return result;
+}
+
+// 比较两个文件并输出编辑脚本。lines 为 true 时按行比较, 输出
+//   @@ -起始行,行数 +起始行,行数 @@  之后是删除的 "-" 行与插入的 "+" 行;
+// 否则按字节比较, 只输出每段改动的字节偏移与长度 (偏移从 0 开始)
+int diffFiles(const string &file1, const string &file2, bool lines) {
+  MappedFile f1, f2;
+  if (!f1.open(file1) || !f2.open(file2)) {
+    return 1;
+  }
+  if (f1.size() > INT32_MAX || f2.size() > INT32_MAX) {
+    cerr << "文件过大 (超过 2 GB)" << endl;
+    return 1;
+  }
+
+  DiffResult result;
+  int m, n;
+  string out;
+  double elapsed;
+  if (lines) {
+    unordered_map<string_view, int> dict;
+    vector<int> ids1, ids2;
+    vector<string_view> lines1, lines2;
+    elapsed = measureTime([&]() {
+      tokenizeLines(f1, dict, ids1, lines1);
+      tokenizeLines(f2, dict, ids2, lines2);
+      result =
+          diffSequences(ids1.data(), ids1.size(), ids2.data(), ids2.size());
+    });
+    m = ids1.size();
+    n = ids2.size();
+    for (const Hunk &h : result.hunks) {
+      out += "@@ -" + to_string(h.aPos + 1) + "," + to_string(h.aLen) + " +" +
+             to_string(h.bPos + 1) + "," + to_string(h.bLen) + " @@\n";
+      for (int k = h.aPos; k < h.aPos + h.aLen; k++) {
+        out += '-';
+        out.append(lines1[k].data(), lines1[k].size());
+        out += '\n';
+      }
+      for (int k = h.bPos; k < h.bPos + h.bLen; k++) {
+        out += '+';
+        out.append(lines2[k].data(), lines2[k].size());
+        out += '\n';
+      }
+    }
+  } else {
+    m = f1.size();
+    n = f2.size();
+    elapsed = measureTime([&]() {
+      result = diffSequences(f1.data(), m, f2.data(), n);
+    });
+    for (const Hunk &h : result.hunks) {
+      out += "@@ -" + to_string(h.aPos) + "," + to_string(h.aLen) + " +" +
+             to_string(h.bPos) + "," + to_string(h.bLen) + " @@\n";
+    }
+  }
+
+  const char *unit = lines ? " 行" : " 字节";
+  cout << out;
+  cout << "========================================" << endl;
+  cout << file1 << ": " << m << unit << ", " << file2 << ": " << n << unit
+       << endl;
+  cout << "公共前缀 " << result.prefix << ", 公共后缀 " << result.suffix
+       << ", LCS 长度 " << result.lcs << ", 改动 " << result.hunks.size()
+       << " 处 (删除 " << m - result.lcs << ", 插入 " << n - result.lcs
+       << ")" << endl;
+  cout << fixed << setprecision(2) << "耗时: " << elapsed << " 毫秒 ("
+       << result.engine << ")" << endl;
+  return 0;
+}
+
+// ==========================================
+// Part9.时间 O(Σ|c| * |q| / 64 / p), 空间 O(σ * |q| / 64)
+// 功能: 批量打分 (一个查询串对多个候选串, 或一组串两两之间)
+// ==========================================
+// 逐对调用位并行引擎时, 查询串的掩码表每次都要重建。批量打分时:
+//   1. 查询串的掩码表只建一次, 各线程只读共享;
+//   2. 候选串按小块从原子计数器领取, 串长不一时各线程也能均衡;
+//   3. 每个线程复用自己的位向量与计数数组, 打分时不分配内存;
+//   4. 先用两个上界剪掉不可能达到阈值的候选串:
+//        LCS <= min(|q|, |c|)                  (长度, O(1))
+//        LCS <= Σ min(cnt_q(x), cnt_c(x))      (字符计数, O(|c|))
+// 相似度取 2 * LCS / (|a| + |b|), 在 [0, 1] 内, 两串相同时为 1。
+const int BATCH_CHUNK = 16; // 每次从计数器领取的候选串个数
+
+struct BatchScore {
+  int lcs;           // LCS 长度, 被上界剪掉时为 -1
+  double similarity; // 相似度, 被剪掉时为 0
+};
+
+double lcsSimilarity(int lcs, size_t m, size_t n) {
+  return m + n == 0 ? 1.0 : 2.0 * lcs / (m + n);
+}
+
+// 每个线程一份, 反复打分时复用
+struct BatchWorkspace {
+  vector<uint64_t> V;
+  array<int, 256> counts;
+};
+
+// 把任务 [0, count) 分给 threads 个线程 (为 0 时取 CPU 核数),
+// 每次领取 chunk 个; work(k, ws) 处理第 k 个任务, ws 为本线程的工作空间
+template <typename Work>
+void runBatch(int count, int threads, int chunk, Work work) {
+  if (threads <= 0) {
+    threads = max(1u, thread::hardware_concurrency());
+  }
+  threads = max(1, min(threads, (count + chunk - 1) / chunk));
+  atomic<int> next(0);
+  auto worker = [&]() {
+    BatchWorkspace ws;
+    for (;;) {
+      int begin = next.fetch_add(chunk, memory_order_relaxed);
+      if (begin >= count) {
+        return;
+      }
+      for (int k = begin; k < min(count, begin + chunk); k++) {
+        work(k, ws);
+      }
+    }
+  };
+  vector<thread> pool;
+  for (int t = 1; t < threads; t++) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (thread &th : pool) {
+    th.join();
+  }
+}
+
+// 预处理好的查询串: 掩码表与字符计数只算一次
+class LcsBatchScorer {
+private:
+  string_view query;
+  BitParallelLCS engine;
+  array<int, 256> counts{};
+
+public:
+  explicit LcsBatchScorer(string_view q)
+      : query(q),
+        engine((const unsigned char *)q.data(), q.length(), 256) {
+    for (unsigned char c : q) {
+      counts[c]++;
+    }
+  }
+
+  // 与 candidate 打分; 上界算出的相似度低于 minSimilarity 时直接返回 -1
+  BatchScore score(string_view candidate, double minSimilarity,
+                   BatchWorkspace &ws) const {
+    size_t m = query.length(), n = candidate.length();
+    int bound = min(m, n);
+    if (minSimilarity > 0 && lcsSimilarity(bound, m, n) >= minSimilarity) {
+      ws.counts.fill(0);
+      for (unsigned char c : candidate) {
+        ws.counts[c]++;
+      }
+      bound = 0;
+      for (int x = 0; x < 256; x++) {
+        bound += min(counts[x], ws.counts[x]);
+      }
+    }
+    if (lcsSimilarity(bound, m, n) < minSimilarity) {
+      return {-1, 0};
+    }
+    int lcs = engine.length((const unsigned char *)candidate.data(), n, ws.V);
+    return {lcs, lcsSimilarity(lcs, m, n)};
+  }
+};
+
+// query 与每个候选串的 LCS 长度与相似度, 结果与 candidates 一一对应
+vector<BatchScore> lcsScoreBatch(string_view query,
+                                 const vector<string> &candidates,
+                                 double minSimilarity = 0, int threads = 0) {
+  vector<BatchScore> scores(candidates.size());
+  LcsBatchScorer scorer(query);
+  runBatch(candidates.size(), threads, BATCH_CHUNK,
+           [&](int k, BatchWorkspace &ws) {
+             scores[k] = scorer.score(candidates[k], minSimilarity, ws);
+           });
+  return scores;
+}
+
+// items 两两之间的 LCS 长度与相似度, 按行存放的 n * n 矩阵。
+// 第 i 行以 items[i] 为查询串, 只算 j > i 的一半再对称填入;
+// 行的工作量递减, 因此每次只领取一行
+vector<BatchScore> lcsScoreAllPairs(const vector<string> &items,
+                                    double minSimilarity = 0,
+                                    int threads = 0) {
+  size_t n = items.size();
+  vector<BatchScore> scores(n * n);
+  runBatch(n, threads, 1, [&](int i, BatchWorkspace &ws) {
+    LcsBatchScorer scorer(items[i]);
+    scores[i * n + i] = {(int)items[i].length(), 1.0};
+    for (size_t j = i + 1; j < n; j++) {
+      scores[i * n + j] = scores[j * n + i] =
+          scorer.score(items[j], minSimilarity, ws);
+    }
+  });
+  return scores;
+}
+
+// ==========================================
+// Part10.时间 O(k * min(m, n)), 空间 O(n)
+// 功能: 加权编辑距离 (Levenshtein), 带状 DP + 距离上限
+// ==========================================
+// dp[i][j] 为 a 前 i 个字符变成 b 前 j 个字符的最小代价:
+//   dp[i][j] = min(dp[i-1][j] + 删除, dp[i][j-1] + 插入,
+//                  dp[i-1][j-1] + (a[i-1] == b[j-1] ? 0 : 替换))
+// 与 Part3 一样只保留一行。格子 (i, j) 所在的对角线 d = j - i 与 (0, 0)、
+// (m, n) 所在的对角线 0、Δ = n - m 分别相差 |d| 和 |Δ - d|, 每跨一条对角线
+// 至少要一次插入或删除, 所以经过该格子的编辑代价至少为
+//   (|d| + |Δ - d|) * min(插入, 删除)
+// 给定上限 k 时只需计算满足该下界 <= k 的对角线, 即宽度约 k / min(插入,
+// 删除) 的一条带 (Ukkonen)。某一行带内的最小值已超过 k 时提前结束。
+struct EditCosts {
+  int insert = 1;     // 在 a 中插入一个字符
+  int erase = 1;      // 从 a 中删除一个字符
+  int substitute = 1; // 替换一个字符 (相同字符代价为 0)
+};
+
+const int EDIT_INF = INT_MAX / 2; // 带外的格子, 加上任意代价也不会溢出
+
+// 完整的一行 DP, 时间 O(mn), 作为带状版本的对照
+int editDistanceFull(string_view a, string_view b, const EditCosts &costs,
+                     LcsWorkspace &ws) {
+  int m = a.length(), n = b.length();
+  int *dp = ws.rows(n + 1);
+  for (int j = 0; j <= n; j++) {
+    dp[j] = j * costs.insert;
+  }
+  for (int i = 1; i <= m; i++) {
+    int prev_diag = dp[0];
+    dp[0] = i * costs.erase;
+    for (int j = 1; j <= n; j++) {
+      int temp = dp[j];
+      int diag = prev_diag + (a[i - 1] == b[j - 1] ? 0 : costs.substitute);
+      dp[j] = min(diag, min(dp[j] + costs.erase, dp[j - 1] + costs.insert));
+      prev_diag = temp;
+    }
+  }
+  return dp[n];
+}
+
+// 带状 DP: 编辑距离不超过 maxDistance 时返回它, 否则返回 -1
+int editDistanceBanded(string_view a, string_view b, int maxDistance,
+                       EditCosts costs, LcsWorkspace &ws) {
+  INSTRUMENT_SCOPE("edit.banded");
+  // 逐行处理较短的串; 交换两串时插入与删除的代价随之交换
+  if (a.length() > b.length()) {
+    swap(a, b);
+    swap(costs.insert, costs.erase);
+  }
+  int m = a.length(), n = b.length();
+  int delta = n - m;
+  int minIndel = min(costs.insert, costs.erase);
+  // 可以偏离的对角线条数; 插入或删除免费时无法限制带宽
+  long long width = minIndel > 0 ? maxDistance / minIndel : m + n;
+  if (maxDistance < 0 || abs(delta) > width) {
+    return -1;
+  }
+  int slack = (width - abs(delta)) / 2;
+  int lo = min(0, delta) - slack; // 带的对角线范围 [lo, hi]
+  int hi = max(0, delta) + slack;
+
+  int *dp = ws.rows(n + 1);
+  for (int j = 0; j <= n; j++) {
+    dp[j] = j <= hi ? j * costs.insert : EDIT_INF;
+  }
+  for (int i = 1; i <= m; i++) {
+    int first = max(0, i + lo), last = min(n, i + hi);
+    int prev_diag, rowMin;
+    if (first == 0) {
+      prev_diag = dp[0];
+      dp[0] = rowMin = i * costs.erase;
+      first = 1;
+    } else {
+      // 左边一格刚离开带, 置为无穷, 它的旧值是第一格的 "左上角"
+      prev_diag = dp[first - 1];
+      dp[first - 1] = EDIT_INF;
+      rowMin = EDIT_INF;
+    }
+    char c = a[i - 1];
+    for (int j = first; j <= last; j++) {
+      int temp = dp[j];
+      int diag = prev_diag + (c == b[j - 1] ? 0 : costs.substitute);
+      dp[j] = min(diag, min(dp[j] + costs.erase, dp[j - 1] + costs.insert));
+      rowMin = min(rowMin, dp[j]);
+      prev_diag = temp;
+    }
+    // 之后的每一行都由本行转移而来, 代价只增不减
+    if (rowMin > maxDistance) {
+      return -1;
+    }
+  }
+  return dp[n] <= maxDistance ? dp[n] : -1;
+}
+
+// 距离未知时从较小的上限开始, 失败则翻倍 (Ukkonen): 总时间 O(d * min)。
+// 上限达到 m * 删除 + n * 插入 后必然成功
+int editDistance(string_view a, string_view b, const EditCosts &costs,
+                 LcsWorkspace &ws) {
+  long long bound = (long long)a.length() * costs.erase +
+                    (long long)b.length() * costs.insert;
+  long long k = 32;
+  for (;;) {
+    int d = editDistanceBanded(a, b, (int)min(k, bound), costs, ws);
+    if (d >= 0) {
+      return d;
+    }
+    k *= 2;
+  }
+}
+
+int editDistance(string_view a, string_view b,
+                 const EditCosts &costs = EditCosts()) {
+  LcsWorkspace ws;
+  return editDistance(a, b, costs, ws);
+}
+
+// sub 是否为 text 的子序列
+bool isSubsequence(const string &sub, const string &text) {
+  size_t k = 0;
+  for (size_t i = 0; i < text.length() && k < sub.length(); i++) {
+    if (text[i] == sub[k]) {
+      k++;
+    }
+  }
+  return k == sub.length();
+}
+
+// lcs 是否为 a、b 的一个长度为 expected 的公共子序列
+bool validLCS(const string &lcs, const string &a, const string &b,
+              int expected) {
+  return (int)lcs.length() == expected && isSubsequence(lcs, a) &&
+         isSubsequence(lcs, b);
+}
+
+// 把编辑脚本作用到 a 上, 结果应与 b 相同; 同时检查各段改动互不重叠
+bool diffRebuilds(const string &a, const string &b, const DiffResult &diff) {
+  string rebuilt;
+  int i = 0;
+  for (const Hunk &h : diff.hunks) {
+    if (h.aPos < i || h.aLen + h.bLen == 0) {
+      return false;
+    }
+    rebuilt.append(a, i, h.aPos - i);
+    rebuilt.append(b, h.bPos, h.bLen);
+    i = h.aPos + h.aLen;
+  }
+  rebuilt.append(a, i, string::npos);
+  return rebuilt == b;
+}
+
+// 正确性检查: 随机长度 / 字母表大小的串, 各引擎结果与一维压缩 DP 对照;
+// 每 50 组用一对较长的串, 使 Hirschberg 真正递归并走到并行分支
+int runCheck(int trials) {
+  mt19937 gen(42);
+  LcsWorkspace ws; // 跨组复用, 检查缓冲区中的旧内容不影响结果
+  string lcs;
+  for (int t = 0; t < trials; t++) {
+    int sigma = 1 + gen() % 26;
+    int maxLen = t % 50 == 0 ? 4000 : 700;
+    string a = randomText(gen, gen() % maxLen, sigma);
+    string b = randomText(gen, gen() % maxLen, sigma);
+    int expected = lcsLengthCompressed(a, b);
+    lcsStringStandard(a, b, ws, lcs);
+    if (lcsLengthRollingModulo(a, b) != expected ||
+        lcsLengthRolling(a, b, ws) != expected ||
+        lcsLengthCompressed(a, b, ws) != expected ||
+        lcs != lcsStringNested(a, b) ||
+        lcsLengthBitParallel(a, b, false) != expected ||
+        lcsLengthBitParallel(a, b, true) != expected ||
+        lcsLengthWavefront(a, b, 1) != expected ||
+        lcsLengthWavefront(a, b, 3) != expected ||
+        lcsLengthWavefront(a, b, 2, false) != expected ||
+        lcsStringStandard(a, b) != lcsStringNested(a, b) ||
+        lcsStringPacked(a, b) != lcsStringNested(a, b) ||
+        !validLCS(lcsStringHirschberg(a, b, 1), a, b, expected) ||
+        !validLCS(lcsStringHirschberg(a, b, 4), a, b, expected) ||
+        lcsLengthAuto(a, b) != expected) {
+      cout << "第 " << t << " 组校验失败: |a| = " << a.size()
+           << ", |b| = " << b.size() << ", σ = " << sigma << endl;
+      return 1;
+    }
+    // 编辑脚本: 比较 a 与 b, 以及 b 与对 b 做少量替换 / 插入 / 删除得到的 c
+    string c = b;
+    for (int e = gen() % 6; e > 0; e--) {
+      size_t pos = gen() % (c.size() + 1);
+      if (e % 3 == 0 || c.empty()) {
+        c.insert(pos, 1, 'a' + gen() % sigma);
+      } else if (e % 3 == 1 && pos < c.size()) {
+        c.erase(pos, 1);
+      } else if (pos < c.size()) {
+        c[pos] = 'a' + gen() % sigma;
+      }
+    }
+    // 不设上限的 Myers 对任意输入都应给出正确的距离与匹配
+    const unsigned char *pa = (const unsigned char *)a.data();
+    const unsigned char *pb = (const unsigned char *)b.data();
+    int total = a.size() + b.size();
+    vector<int> vf(total + 4), vb(total + 4);
+    vector<MatchPair> matches;
+    myersMatches(pa, a.size(), pb, b.size(), 0, 0, matches, vf.data(),
+                 vb.data());
+    bool ordered = (int)matches.size() == expected;
+    for (size_t k = 0; ordered && k < matches.size(); k++) {
+      const MatchPair &match = matches[k];
+      ordered = a[match.first] == b[match.second] &&
+                (k == 0 || (matches[k - 1].first < match.first &&
+                            matches[k - 1].second < match.second));
+    }
+    if (myersDistance(pa, a.size(), pb, b.size(), total) !=
+            total - 2 * expected ||
+        !ordered) {
+      cout << "第 " << t << " 组 Myers 校验失败" << endl;
+      return 1;
+    }
+    for (const string *x : {&a, &c}) {
+      DiffResult diff =
+          diffSequences((const unsigned char *)x->data(), x->size(),
+                        (const unsigned char *)b.data(), b.size());
+      if (diff.lcs != lcsLengthCompressed(*x, b) ||
+          !diffRebuilds(*x, b, diff)) {
+        cout << "第 " << t << " 组编辑脚本校验失败" << endl;
+        return 1;
+      }
+    }
+  }
+  // 符号几乎互不相同 (相当于按行比较两个内容无关的文件) 时, 位并行的掩码表
+  // 过大, 自动选择应回退到一行 DP, 结果仍与位并行一致
+  {
+    const int n = 20000, alphabet = 1 << 20;
+    vector<int> x(n), y(n);
+    for (int k = 0; k < n; k++) {
+      x[k] = gen() % alphabet;
+      y[k] = gen() % alphabet;
+    }
+    const char *engine = "";
+    int autoLen = lcsLengthAuto(x.data(), n, y.data(), n, alphabet, &engine);
+    int expected = BitParallelLCS(y.data(), n, alphabet).length(x.data(), n);
+    if (autoLen != expected || string(engine) != "一行 DP") {
+      cout << "大字母表自动选择校验失败 (" << engine << ")" << endl;
+      return 1;
+    }
+  }
+  // 编辑距离: 随机代价下带状版本与完整一行 DP 对照, 上限恰好等于距离时
+  // 成功、小 1 时失败; 插入删除各 1、替换 2 时距离为 m + n - 2 * LCS
+  for (int t = 0; t < trials; t++) {
+    int sigma = 1 + gen() % 8;
+    string a = randomText(gen, gen() % 200, sigma);
+    string b = t % 2 ? randomText(gen, gen() % 200, sigma) : a;
+    for (int e = gen() % 10; e > 0; e--) {
+      b.insert(gen() % (b.size() + 1), 1, 'a' + gen() % sigma);
+      b.erase(gen() % b.size(), 1);
+    }
+    EditCosts costs;
+    costs.insert = gen() % 4;
+    costs.erase = 1 + gen() % 3;
+    costs.substitute = gen() % 5;
+    int expected = editDistanceFull(a, b, costs, ws);
+    EditCosts indel{1, 1, 2};
+    if (editDistanceBanded(a, b, expected, costs, ws) != expected ||
+        (expected > 0 &&
+         editDistanceBanded(a, b, expected - 1, costs, ws) != -1) ||
+        editDistance(a, b, costs, ws) != expected ||
+        editDistance(a, b, indel) !=
+            (int)(a.size() + b.size()) - 2 * lcsLengthCompressed(a, b)) {
+      cout << "第 " << t << " 组编辑距离校验失败: |a| = " << a.size()
+           << ", |b| = " << b.size() << endl;
+      return 1;
+    }
+  }
+
+  // 批量打分: 与逐对的一维压缩 DP 对照; 被剪掉的候选串真实相似度
+  // 必须低于阈值
+  vector<string> items;
+  for (int k = 0; k < 60; k++) {
+    items.push_back(randomText(gen, gen() % 300, 2 + k % 6));
+  }
+  size_t count = items.size();
+  auto scoreOk = [](const BatchScore &s, int expected, size_t m, size_t n,
+                    double minSimilarity) {
+    double similarity = lcsSimilarity(expected, m, n);
+    return s.lcs < 0 ? similarity < minSimilarity
+                     : s.lcs == expected && s.similarity == similarity;
+  };
+  for (double minSimilarity : {0.0, 0.7}) {
+    vector<BatchScore> batch =
+        lcsScoreBatch(items[0], items, minSimilarity, 3);
+    vector<BatchScore> pairs = lcsScoreAllPairs(items, minSimilarity, 3);
+    for (size_t i = 0; i < count; i++) {
+      for (size_t j = 0; j < count; j++) {
+        const string &a = items[i], &b = items[j];
+        int expected = lcsLengthCompressed(a, b);
+        if (!scoreOk(pairs[i * count + j], expected, a.size(), b.size(),
+                     minSimilarity) ||
+            (i == 0 && !scoreOk(batch[j], expected, a.size(), b.size(),
+                                minSimilarity))) {
+          cout << "批量打分校验失败: (" << i << ", " << j << ")" << endl;
+          return 1;
+        }
+      }
+    }
+  }
+  cout << "随机测试 " << trials << " 组, 校验通过" << endl;
+  return 0;
+}
+
+// 基准测试: 两个长度为 n 的随机串, 对比一维压缩 DP 与位并行 (标量 / AVX2)
+int benchEngines(int n) {
+  mt19937 gen(7);
+  cout << "========== LCS 长度 (n = " << n << ") ==========" << endl;
+  cout << fixed << setprecision(2);
+  for (int sigma : {4, 26}) {
+    string a = randomText(gen, n, sigma), b = randomText(gen, n, sigma);
+    int dpLen = 0, scalarLen = 0, simdLen = 0;
+    double dpTime = measureTime([&]() { dpLen = lcsLengthCompressed(a, b); });
+    double scalarTime =
+        measureTime([&]() { scalarLen = lcsLengthBitParallel(a, b, false); });
+    double simdTime =
+        measureTime([&]() { simdLen = lcsLengthBitParallel(a, b, true); });
+    bool ok = dpLen == scalarLen && dpLen == simdLen;
+    cout << "σ = " << sigma << ", LCS = " << dpLen
+         << (ok ? "" : " (结果不一致!)") << endl;
+    cout << "  一维压缩 DP:   " << dpTime << " 毫秒" << endl;
+    cout << "  位并行 (标量): " << scalarTime << " 毫秒 ("
+         << dpTime / scalarTime << "x)" << endl;
+    cout << "  位并行 (AVX2"
+         << (BitParallelLCS::simdAvailable() ? "" : " 不可用") << "): "
+         << simdTime << " 毫秒 (" << dpTime / simdTime << "x)" << endl;
+    if (!ok) {
+      return 1;
+    }
+  }
+  return 0;
 }
 
-int main() {
+// 基准测试: 求 LCS 字符串, 对比标准二维 DP (表格超过 2 GB 时跳过)
+// 与 Hirschberg 单线程 / 多线程的耗时与工作空间
+int benchString(int n) {
+  mt19937 gen(11);
+  string a = randomText(gen, n, 4), b = randomText(gen, n, 4);
+  int expected = lcsLengthBitParallel(a, b);
+  cout << "========== LCS 字符串 (n = " << n << ", "
+       << thread::hardware_concurrency() << " 线程) ==========" << endl;
+  cout << fixed << setprecision(2);
+  bool ok = true;
+  double tableMB = (double)(n + 1) * (n + 1) * sizeof(int) / (1 << 20);
+  if (tableMB <= 2048) {
+    string lcs;
+    double t = measureTime([&]() { lcs = lcsStringStandard(a, b); });
+    ok = ok && validLCS(lcs, a, b, expected);
+    cout << "标准二维 DP:          " << t << " 毫秒, DP 表 " << tableMB
+         << " MB" << endl;
+  } else {
+    cout << "标准二维 DP:          跳过 (DP 表需要 " << tableMB << " MB)"
+         << endl;
+  }
+  double rowKB = 2.0 * (n + 1) * sizeof(int) / 1024;
+  for (int threads : {1, 0}) {
+    string lcs;
+    double t =
+        measureTime([&]() { lcs = lcsStringHirschberg(a, b, threads); });
+    ok = ok && validLCS(lcs, a, b, expected);
+    cout << "Hirschberg (" << (threads == 1 ? "单线程" : "多线程")
+         << "): " << t << " 毫秒, 每层两行 " << rowKB << " KB" << endl;
+  }
+  cout << "LCS 长度 " << expected << ", 结果" << (ok ? "正确" : "错误")
+       << endl;
+  return ok ? 0 : 1;
+}
+
+// 基准测试: 两个长度为 n 的随机串, 分块波前在 1, 2, 4, ... 直到 cores 个
+// 线程下的耗时与吞吐 (cores 为 0 时取 CPU 核数; n <= 50000 时同时给出
+// 一维压缩 DP 作对照)
+int benchWavefront(int n, int cores) {
+  mt19937 gen(13);
+  string a = randomText(gen, n, 4), b = randomText(gen, n, 4);
+  int expected = lcsLengthBitParallel(a, b);
+  if (cores <= 0) {
+    cores = max(1u, thread::hardware_concurrency());
+  }
+  double cells = (double)n * n;
+  cout << "========== 分块波前 (n = " << n << ", " << cores
+       << " 核) ==========" << endl;
+  cout << fixed << setprecision(2);
+  bool ok = true;
+  double base = 0;
+  if (n <= 50000) {
+    int len = 0;
+    base = measureTime([&]() { len = lcsLengthCompressed(a, b); });
+    ok = ok && len == expected;
+    cout << "一维压缩 DP:    " << base << " 毫秒, "
+         << cells / base / 1e6 << " G 格/秒" << endl;
+  }
+  double single = 0;
+  for (int threads = 1;; threads *= 2) {
+    int t = min(threads, cores);
+    int len = 0;
+    double time = measureTime([&]() { len = lcsLengthWavefront(a, b, t); });
+    ok = ok && len == expected;
+    if (t == 1) {
+      single = time;
+    }
+    cout << "波前 " << setw(3) << t << " 线程: " << time << " 毫秒, "
+         << cells / time / 1e6 << " G 格/秒, 相对单线程 " << single / time
+         << "x";
+    if (base > 0) {
+      cout << ", 相对一维压缩 " << base / time << "x";
+    }
+    cout << endl;
+    if (t == cores) {
+      break;
+    }
+  }
+  cout << "LCS 长度 " << expected << ", 结果" << (ok ? "一致" : "不一致")
+       << endl;
+  return ok ? 0 : 1;
+}
+
+// 基准测试: 求 LCS 字符串时各种 DP 表布局的耗时与内存
+int benchTable(int n) {
+  mt19937 gen(17);
+  string a = randomText(gen, n, 4), b = randomText(gen, n, 4);
+  double cells = (double)(n + 1) * (n + 1) / (1 << 20);
+  string expected;
+  double nestedTime =
+      measureTime([&]() { expected = lcsStringNested(a, b); });
+  cout << "========== DP 表布局 (n = " << n << ") ==========" << endl;
+  cout << fixed << setprecision(2);
+  cout << "vector<vector<int>>: " << nestedTime << " 毫秒, "
+       << cells * sizeof(int) << " MB, " << n + 1 << " 次分配" << endl;
+
+  bool ok = true;
+  auto run = [&](const char *name, double mb, auto solve) {
+    string lcs;
+    double t = measureTime([&]() { lcs = solve(); });
+    ok = ok && lcs == expected;
+    cout << name << t << " 毫秒, " << mb << " MB (" << nestedTime / t
+         << "x)" << endl;
+  };
+  run("连续 int:            ", cells * sizeof(int),
+      [&]() { return lcsStringFlat<int>(a, b); });
+  if (n <= UINT16_MAX) {
+    run("连续 uint16_t:       ", cells * sizeof(uint16_t),
+        [&]() { return lcsStringFlat<uint16_t>(a, b); });
+  }
+  run("2 位方向矩阵:        ", cells / 4,
+      [&]() { return lcsStringPacked(a, b); });
+  cout << "LCS 长度 " << expected.length() << ", 结果"
+       << (ok ? "一致" : "不一致") << endl;
+  return ok ? 0 : 1;
+}
+
+// 对 s 做 edits 次随机编辑 (替换 / 插入 / 删除各占三分之一)
+string mutate(mt19937 &gen, string s, int edits, int sigma) {
+  for (int e = 0; e < edits; e++) {
+    size_t pos = gen() % (s.size() + 1);
+    int op = gen() % 3;
+    if (op == 0 || s.empty()) {
+      s.insert(pos, 1, 'a' + gen() % sigma);
+    } else if (pos < s.size()) {
+      if (op == 1) {
+        s.erase(pos, 1);
+      } else {
+        s[pos] = 'a' + gen() % sigma;
+      }
+    }
+  }
+  return s;
+}
+
+// 基准测试: 长度为 n 的随机串与它做 e 次随机编辑后的版本, e 从 1 逐步
+// 增大, 对比一维压缩 DP、位并行、Myers 与自动选择的耗时, 找出交叉点
+int benchCrossover(int n) {
+  mt19937 gen(19);
+  string a = randomText(gen, n, 26);
+  const unsigned char *pa = (const unsigned char *)a.data();
+  cout << "========== Myers 交叉点 (n = " << n << ", 自动选择的上限 d <= "
+       << myersLimit(n, n) << ") ==========" << endl;
+  cout << fixed << setprecision(2);
+  cout << "  编辑数        d    一维压缩       位并行        Myers     自动选择"
+       << endl;
+  bool ok = true;
+  for (int edits = 1; edits <= n; edits *= 4) {
+    string b = mutate(gen, a, edits, 26);
+    const unsigned char *pb = (const unsigned char *)b.data();
+    int expected = 0, bitLen = 0, d = 0, autoLen = 0;
+    const char *engine = "";
+    double dpTime =
+        measureTime([&]() { expected = lcsLengthCompressed(a, b); });
+    double bitTime =
+        measureTime([&]() { bitLen = lcsLengthBitParallel(a, b); });
+    double myersTime = measureTime([&]() {
+      d = myersDistance(pa, a.size(), pb, b.size(), a.size() + b.size());
+    });
+    double autoTime =
+        measureTime([&]() { autoLen = lcsLengthAuto(a, b, &engine); });
+    ok = ok && bitLen == expected && autoLen == expected &&
+         d == (int)(a.size() + b.size()) - 2 * expected;
+    cout << setw(8) << edits << setw(9) << d << setw(12) << dpTime
+         << setw(13) << bitTime << setw(13) << myersTime << setw(13)
+         << autoTime << " 毫秒 (" << engine << ")" << endl;
+  }
+  cout << "结果" << (ok ? "一致" : "不一致") << endl;
+  return ok ? 0 : 1;
+}
+
+// 基准测试: 长度为 len 的查询串对 count 个候选串 (一半由查询串随机编辑
+// 得到, 一半是长度不一的随机串), 对比逐对调用位并行引擎与批量打分;
+// 再取前 200 个候选串比较两两打分
+int benchBatch(int count, int len) {
+  mt19937 gen(23);
+  string query = randomText(gen, len, 26);
+  vector<string> candidates;
+  for (int k = 0; k < count; k++) {
+    if (k % 2 == 0) {
+      candidates.push_back(mutate(gen, query, gen() % (len / 4 + 1), 26));
+    } else {
+      candidates.push_back(randomText(gen, len / 4 + gen() % (2 * len), 26));
+    }
+  }
+  cout << "========== 批量打分 (" << count << " 个候选串, |q| = " << len
+       << ", " << thread::hardware_concurrency() << " 线程) =========="
+       << endl;
+  cout << fixed << setprecision(2);
+
+  vector<int> expected(count);
+  double pairTime = measureTime([&]() {
+    for (int k = 0; k < count; k++) {
+      expected[k] = lcsLengthBitParallel(query, candidates[k]);
+    }
+  });
+  bool ok = true;
+  auto report = [&](const char *name, double minSimilarity, int threads) {
+    vector<BatchScore> scores;
+    double t = measureTime([&]() {
+      scores = lcsScoreBatch(query, candidates, minSimilarity, threads);
+    });
+    int skipped = 0;
+    for (int k = 0; k < count; k++) {
+      if (scores[k].lcs < 0) {
+        skipped++;
+        ok = ok && lcsSimilarity(expected[k], len, candidates[k].size()) <
+                       minSimilarity;
+      } else {
+        ok = ok && scores[k].lcs == expected[k];
+      }
+    }
+    cout << name << t << " 毫秒 (" << pairTime / t << "x), 剪掉 " << skipped
+         << " 个" << endl;
+  };
+  cout << "逐对位并行:             " << pairTime << " 毫秒" << endl;
+  report("批量 (单线程):          ", 0, 1);
+  report("批量 (多线程):          ", 0, 0);
+  report("批量 (多线程, 阈值 0.8): ", 0.8, 0);
+
+  vector<string> items(candidates.begin(),
+                       candidates.begin() + min(count, 200));
+  size_t n = items.size();
+  vector<int> naive(n * n);
+  double naiveTime = measureTime([&]() {
+    for (size_t i = 0; i < n; i++) {
+      for (size_t j = 0; j < n; j++) {
+        naive[i * n + j] = lcsLengthBitParallel(items[i], items[j]);
+      }
+    }
+  });
+  vector<BatchScore> pairs;
+  double allTime = measureTime([&]() { pairs = lcsScoreAllPairs(items); });
+  for (size_t k = 0; k < n * n; k++) {
+    ok = ok && pairs[k].lcs == naive[k];
+  }
+  cout << "两两打分 (" << n << " x " << n << "): 逐对 " << naiveTime
+       << " 毫秒, 批量 " << allTime << " 毫秒 (" << naiveTime / allTime
+       << "x)" << endl;
+  cout << "结果" << (ok ? "一致" : "不一致") << endl;
+  return ok ? 0 : 1;
+}
+
+// 基准测试: 长度为 n 的随机串与它做 e 次随机编辑后的版本, 对比完整一行
+// DP、上限 k 的带状 DP 与上限翻倍的 editDistance (Levenshtein 代价)
+int benchEdit(int n, int k) {
+  mt19937 gen(31);
+  string a = randomText(gen, n, 26);
+  LcsWorkspace ws;
+  EditCosts costs;
+  cout << "========== 编辑距离 (n = " << n << ", 上限 k = " << k
+       << ") ==========" << endl;
+  cout << fixed << setprecision(2);
+  cout << "  编辑数     距离    完整 DP    带状 (k)     翻倍" << endl;
+  bool ok = true;
+  for (int edits = 1; edits <= n; edits *= 4) {
+    string b = mutate(gen, a, edits, 26);
+    int full = 0, banded = 0, doubling = 0;
+    double fullTime =
+        measureTime([&]() { full = editDistanceFull(a, b, costs, ws); });
+    double bandTime = measureTime(
+        [&]() { banded = editDistanceBanded(a, b, k, costs, ws); });
+    double doublingTime =
+        measureTime([&]() { doubling = editDistance(a, b, costs, ws); });
+    ok = ok && doubling == full && banded == (full <= k ? full : -1);
+    cout << setw(8) << edits << setw(9) << full << setw(11) << fullTime
+         << setw(12) << bandTime << (banded < 0 ? "*" : " ") << setw(9)
+         << doublingTime << " 毫秒" << endl;
+  }
+  cout << "(* 表示距离超过上限, 提前结束)" << endl;
+  cout << "结果" << (ok ? "一致" : "不一致") << endl;
+  return ok ? 0 : 1;
+}
+
+// 微基准: 64 对长度为 len 的短串轮流求解 calls 次, 比较每次调用的开销:
+// 原始的按值传参 + 取模、每次新建工作空间、复用同一个工作空间
+int benchMicro(int len, int calls) {
+  mt19937 gen(29);
+  vector<string> a, b;
+  for (int k = 0; k < 64; k++) {
+    a.push_back(randomText(gen, len, 4));
+    b.push_back(randomText(gen, len + k % 8, 4));
+  }
+  cout << "========== 单次调用开销 (|a| = " << len << ", " << calls
+       << " 次) ==========" << endl;
+  cout << fixed << setprecision(1);
+  long long expected = -1;
+  bool ok = true;
+  // 返回每次调用的平均纳秒数; 各写法的长度之和必须一致
+  auto perCall = [&](const char *name, auto solve) {
+    long long sum = 0;
+    double t = measureTime([&]() {
+      for (int k = 0; k < calls; k++) {
+        sum += solve(a[k % 64], b[k % 64]);
+      }
+    });
+    if (expected < 0) {
+      expected = sum;
+    }
+    ok = ok && sum == expected;
+    cout << name << t * 1e6 / calls << " 纳秒 / 次" << endl;
+  };
+  LcsWorkspace ws;
+  string lcs;
+  perCall("滚动数组 (按值 + 取模):      ",
+          [](const string &x, const string &y) {
+            return lcsLengthRollingModulo(x, y);
+          });
+  perCall("滚动数组 (指针交换):         ", [](string_view x, string_view y) {
+    return lcsLengthRolling(x, y);
+  });
+  perCall("滚动数组 (复用工作空间):     ", [&](string_view x, string_view y) {
+    return lcsLengthRolling(x, y, ws);
+  });
+  perCall("一维压缩 (每次分配):         ", [](string_view x, string_view y) {
+    return lcsLengthCompressed(x, y);
+  });
+  perCall("一维压缩 (复用工作空间):     ", [&](string_view x, string_view y) {
+    return lcsLengthCompressed(x, y, ws);
+  });
+  perCall("二维 DP (vector<vector>):    ", [](string_view x, string_view y) {
+    return (int)lcsStringNested(x, y).length();
+  });
+  perCall("二维 DP (每次分配):          ", [](string_view x, string_view y) {
+    return (int)lcsStringStandard(x, y).length();
+  });
+  perCall("二维 DP (复用工作空间):      ", [&](string_view x, string_view y) {
+    lcsStringStandard(x, y, ws, lcs);
+    return (int)lcs.length();
+  });
+  cout << "结果" << (ok ? "一致" : "不一致") << endl;
+  return ok ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+  // 其他模式：./LCS check [组数] | bench [n] | string [n] | table [n]
+  //           | wavefront [n] [最大线程数]
+  //           | diff <文件1> <文件2> [lines | bytes] | crossover [n]
+  //           | batch [候选串个数] [查询串长度] | micro [串长] [调用次数]
+  //           | edit [n] [距离上限]
+  if (argc > 1) {
+    string mode = argv[1];
+    if (mode == "check") {
+      return runCheck(argc > 2 ? stoi(argv[2]) : 2000);
+    }
+    if (mode == "bench") {
+      return benchEngines(argc > 2 ? stoi(argv[2]) : 30000);
+    }
+    if (mode == "wavefront") {
+      return benchWavefront(argc > 2 ? stoi(argv[2]) : 100000,
+                            argc > 3 ? stoi(argv[3]) : 0);
+    }
+    if (mode == "diff" && argc > 3) {
+      bool lines = argc <= 4 || string(argv[4]) != "bytes";
+      return diffFiles(argv[2], argv[3], lines);
+    }
+    if (mode == "crossover") {
+      return benchCrossover(argc > 2 ? stoi(argv[2]) : 20000);
+    }
+    if (mode == "edit") {
+      return benchEdit(argc > 2 ? stoi(argv[2]) : 20000,
+                       argc > 3 ? stoi(argv[3]) : 64);
+    }
+    if (mode == "micro") {
+      return benchMicro(argc > 2 ? stoi(argv[2]) : 32,
+                        argc > 3 ? stoi(argv[3]) : 200000);
+    }
+    if (mode == "batch") {
+      return benchBatch(argc > 2 ? stoi(argv[2]) : 5000,
+                        argc > 3 ? stoi(argv[3]) : 1000);
+    }
+    if (mode == "table") {
+      return benchTable(argc > 2 ? stoi(argv[2]) : 10000);
+    }
+    if (mode == "string") {
+      return benchString(argc > 2 ? stoi(argv[2]) : 20000);
+    }
+    cerr << "未知模式: " << mode << endl;
+    return 1;
+  }
+
   string text1, text2;
 
   // 控制台输入
@@ -145,6 +2233,9 @@ int main() {
   solveStandard(text1, text2);
   solveRollingArray(text1, text2);
   solveCompressed(text1, text2);
+  solveBitParallel(text1, text2);
+  solveHirschberg(text1, text2);
+  solveWavefront(text1, text2);
 
   return 0;
 }
\ No newline at end of file
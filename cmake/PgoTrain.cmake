@@ -0,0 +1,72 @@
+# PGO 训练脚本, 由 pgo-train 目标以 cmake -P 调用。
+# 参数: SOURCE_DIR, BINARY_DIR, WORK_DIR, PROFILE_DIR, PROFDATA (可为空)
+# 每个实验在 WORK_DIR 下单独的子目录里运行, 输入从源码目录复制过去,
+# 程序写出的 sorted.txt / LNR.txt 等文件也都留在那里
+
+# 清掉上一次训练的数据, 避免与修改后的代码混在一起
+file(REMOVE_RECURSE ${PROFILE_DIR} ${WORK_DIR})
+file(MAKE_DIRECTORY ${PROFILE_DIR})
+
+# run(<实验目录> <程序> [参数...]): 在 WORK_DIR/<实验目录> 下运行,
+# 标准输入取自该目录的 stdin.txt (交互式程序用)
+function(run lab program)
+  set(dir ${WORK_DIR}/${lab})
+  string(JOIN " " args ${ARGN})
+  message(STATUS "训练: ${lab}/${program} ${args}")
+  execute_process(COMMAND ${BINARY_DIR}/${lab}/${program} ${ARGN}
+                  WORKING_DIRECTORY ${dir}
+                  INPUT_FILE ${dir}/stdin.txt
+                  OUTPUT_QUIET
+                  RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${lab}/${program} 运行失败: ${result}")
+  endif()
+endfunction()
+
+# prepare(<实验目录> <标准输入> [输入文件...])
+function(prepare lab stdin)
+  file(MAKE_DIRECTORY ${WORK_DIR}/${lab})
+  file(WRITE ${WORK_DIR}/${lab}/stdin.txt "${stdin}")
+  foreach(input ${ARGN})
+    file(COPY ${SOURCE_DIR}/${lab}/${input} DESTINATION ${WORK_DIR}/${lab})
+  endforeach()
+endfunction()
+
+prepare(Lab1 "" data.txt)
+run(Lab1 parallel_quicksort)
+run(Lab1 parallel_quicksort select)
+run(Lab1 quicksort_optimization)
+
+prepare(Lab2 "" data.txt)
+run(Lab2 closest_pair)
+
+# insert.txt 很小, 另用较小规模的基准模式覆盖批量插入与遍历的热路径
+prepare(Lab3 "" insert.txt)
+run(Lab3 RBTree)
+run(Lab3 RBTree_opt)
+run(Lab3 RBTree_opt bptree)
+run(Lab3 RBTree_opt bulk 200000)
+
+prepare(Lab4 "-1 -1\n" insert.txt)
+run(Lab4 interval_tree)
+run(Lab4 interval_tree check 20000)
+run(Lab4 interval_tree bench 200000)
+
+prepare(Lab5 "ABCBDAB BDCABA\n")
+run(Lab5 LCS)
+run(Lab5 LCS check 200)
+run(Lab5 LCS bench 5000)
+
+# Clang 写出的是 .profraw, 需要合并成 -fprofile-use 读取的 .profdata
+file(GLOB raw ${PROFILE_DIR}/*.profraw)
+if(raw)
+  if(NOT PROFDATA)
+    message(FATAL_ERROR "找不到 llvm-profdata, 无法合并 Clang 剖析数据")
+  endif()
+  execute_process(COMMAND ${PROFDATA} merge -o
+                          ${PROFILE_DIR}/default.profdata ${raw}
+                  RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "llvm-profdata 合并失败: ${result}")
+  endif()
+endif()
@@ -0,0 +1,412 @@
+// ==========================================
+// 各实验共用的计时与热路径打点 (仅头文件)
+// ==========================================
+// 1. Stopwatch / measureTime: 统一的计时工具, 始终可用。
+// 2. INSTRUMENT_SCOPE("名字"): 作用域计时器, 放在热路径上统计各阶段的调用
+//    次数与耗时。只有定义了 LAB_INSTRUMENT 时才生效 (CMake 中为
+//    -DLAB_INSTRUMENT=ON), 否则展开为空语句, 生成的代码与不打点时相同。
+//    生效时:
+//    - 环境变量 LAB_PERF=1 时, 每个线程用 perf_event_open 打开一组硬件
+//      计数器 (cycles, instructions, branch-misses, LLC-misses), 同时累计到
+//      各打点位置; 只支持 Linux, 打不开的计数器自动跳过。
+//    - 各线程把累计值记在自己的 thread_local 表里, 不用原子操作; 线程退出时
+//      并入 Reporter。程序退出时输出汇总, 按总耗时降序排列。环境变量
+//      LAB_INSTRUMENT_OUTPUT 指定输出文件, 扩展名为 .json 时输出 JSON,
+//      否则输出 CSV; 未指定时以 CSV 输出到标准错误。
+//    INSTRUMENT_SCOPE_IF("名字", 条件): 条件为假时不计时, 用于只统计较大的
+//    子问题。
+// 计时包含嵌套的打点。递归函数应在不递归的阶段上打点, 否则同一段时间会在
+// 每一层重复累计。每次打点要读两次时钟 (LAB_PERF=1 时另有两次 read 系统
+// 调用), 不要放在每个元素或每个小子数组都执行一次的位置。
+// 同名的打点位置 (如模板的不同实例) 在汇总时合并。
+#ifndef LAB_COMMON_INSTRUMENT_H
+#define LAB_COMMON_INSTRUMENT_H
+
+#include <chrono>
+
+#ifdef LAB_INSTRUMENT
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#endif
+
+namespace instrument {
+
+// 秒表: 构造时开始计时
+class Stopwatch {
+private:
+  std::chrono::steady_clock::time_point start;
+
+public:
+  Stopwatch() : start(std::chrono::steady_clock::now()) {}
+
+  void reset() { start = std::chrono::steady_clock::now(); }
+
+  // 从开始到现在的毫秒数
+  double elapsedMs() const {
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+};
+
+// 计时辅助：返回 func 的运行时间（毫秒）
+template <typename Func> double measureTime(Func func) {
+  Stopwatch watch;
+  func();
+  return watch.elapsedMs();
+}
+
+#ifdef LAB_INSTRUMENT
+const int COUNTERS = 4;
+const char *const COUNTER_NAMES[COUNTERS] = {"cycles", "instructions",
+                                             "branch_misses", "llc_misses"};
+
+// 当前线程的一组硬件计数器, 以 cycles 为组长一次读出。
+// 某个计数器打不开 (虚拟机、权限不足) 时只是少一列, 组长打不开时整组不可用
+class PerfGroup {
+private:
+  int fds[COUNTERS];
+  int slot[COUNTERS]; // 组内第 k 个值对应的计数器
+  int opened = 0;
+
+public:
+  PerfGroup() {
+    std::fill(fds, fds + COUNTERS, -1);
+#ifdef __linux__
+    const char *env = std::getenv("LAB_PERF");
+    if (env == nullptr || std::strcmp(env, "1") != 0) {
+      return;
+    }
+    const uint64_t configs[COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+    for (int k = 0; k < COUNTERS; k++) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[k];
+      attr.read_format = PERF_FORMAT_GROUP;
+      attr.disabled = k == 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      int leader = k == 0 ? -1 : fds[0];
+      if (k > 0 && leader < 0) {
+        return;
+      }
+      fds[k] = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+      if (fds[k] >= 0) {
+        slot[opened++] = k;
+      }
+    }
+    if (fds[0] >= 0) {
+      ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  ~PerfGroup() {
+#ifdef __linux__
+    for (int fd : fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  PerfGroup(const PerfGroup &) = delete;
+  PerfGroup &operator=(const PerfGroup &) = delete;
+
+  // 读出各计数器的当前值, 未打开的计数器记为 0; 整组不可用时返回 false
+  bool read(uint64_t values[COUNTERS]) const {
+#ifdef __linux__
+    if (fds[0] < 0) {
+      return false;
+    }
+    uint64_t buffer[1 + COUNTERS];
+    ssize_t bytes = ::read(fds[0], buffer, sizeof(uint64_t) * (1 + opened));
+    if (bytes != (ssize_t)(sizeof(uint64_t) * (1 + opened))) {
+      return false;
+    }
+    std::fill(values, values + COUNTERS, 0);
+    for (int k = 0; k < opened; k++) {
+      values[slot[k]] = buffer[1 + k];
+    }
+    return true;
+#else
+    (void)values;
+    return false;
+#endif
+  }
+
+  // 已打开的计数器, 第 k 位对应 COUNTER_NAMES[k]
+  unsigned mask() const {
+    unsigned bits = 0;
+    for (int k = 0; k < COUNTERS; k++) {
+      bits |= (fds[k] >= 0) << k;
+    }
+    return bits;
+  }
+};
+
+inline PerfGroup &threadPerf() {
+  thread_local PerfGroup group;
+  return group;
+}
+
+// 一个打点位置: 首次执行到该位置时分配编号并登记到全局链表。
+// 累计值不放在这里, 由各线程分别累计 (见 ThreadTotals)。
+// 析构函数平凡, 程序退出时直到最后都可以安全读取
+struct Site {
+  const char *name;
+  unsigned id;
+  Site *next = nullptr;
+
+  explicit Site(const char *siteName);
+};
+
+inline std::atomic<Site *> &siteList() {
+  static std::atomic<Site *> head{nullptr};
+  return head;
+}
+
+inline std::atomic<unsigned> &siteCount() {
+  static std::atomic<unsigned> count{0};
+  return count;
+}
+
+inline Site::Site(const char *siteName)
+    : name(siteName), id(siteCount().fetch_add(1)) {
+  next = siteList().load(std::memory_order_relaxed);
+  while (!siteList().compare_exchange_weak(next, this,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+  }
+}
+
+// 一个打点位置的累计值
+struct Totals {
+  uint64_t calls = 0;
+  uint64_t nanos = 0;
+  uint64_t counters[COUNTERS] = {};
+  unsigned available = 0; // 有数据的计数器, 同 PerfGroup::mask
+
+  void add(const Totals &other) {
+    calls += other.calls;
+    nanos += other.nanos;
+    for (int k = 0; k < COUNTERS; k++) {
+      counters[k] += other.counters[k];
+    }
+    available |= other.available;
+  }
+};
+
+// 汇总后的一行
+struct SiteTotal : Totals {
+  std::string name;
+};
+
+// 按名字合并各打点位置, 按总耗时降序写出 (JSON 或 CSV)
+inline void writeReport(FILE *out, bool json,
+                        const std::vector<Totals> &totals) {
+  std::map<std::string, SiteTotal> merged;
+  for (Site *s = siteList().load(std::memory_order_acquire); s != nullptr;
+       s = s->next) {
+    SiteTotal &total = merged[s->name];
+    total.name = s->name;
+    if (s->id < totals.size()) {
+      total.add(totals[s->id]);
+    }
+  }
+  std::vector<SiteTotal> rows;
+  for (auto &entry : merged) {
+    rows.push_back(entry.second);
+  }
+  std::sort(rows.begin(), rows.end(),
+            [](const SiteTotal &a, const SiteTotal &b) {
+              return a.nanos > b.nanos;
+            });
+
+  if (json) {
+    std::fprintf(out, "{\"sites\": [");
+  } else {
+    std::fprintf(out, "name,calls,total_ms,avg_ns");
+    for (const char *counter : COUNTER_NAMES) {
+      std::fprintf(out, ",%s", counter);
+    }
+    std::fprintf(out, "\n");
+  }
+  for (size_t r = 0; r < rows.size(); r++) {
+    const SiteTotal &row = rows[r];
+    double totalMs = row.nanos / 1e6;
+    double avgNs = row.calls ? (double)row.nanos / row.calls : 0;
+    if (json) {
+      std::fprintf(out,
+                   "%s\n  {\"name\": \"%s\", \"calls\": %llu, "
+                   "\"total_ms\": %.3f, \"avg_ns\": %.1f",
+                   r ? "," : "", row.name.c_str(),
+                   (unsigned long long)row.calls, totalMs, avgNs);
+      for (int k = 0; k < COUNTERS; k++) {
+        if (row.available >> k & 1) {
+          std::fprintf(out, ", \"%s\": %llu", COUNTER_NAMES[k],
+                       (unsigned long long)row.counters[k]);
+        }
+      }
+      std::fprintf(out, "}");
+    } else {
+      std::fprintf(out, "%s,%llu,%.3f,%.1f", row.name.c_str(),
+                   (unsigned long long)row.calls, totalMs, avgNs);
+      for (int k = 0; k < COUNTERS; k++) {
+        if (row.available >> k & 1) {
+          std::fprintf(out, ",%llu", (unsigned long long)row.counters[k]);
+        } else {
+          std::fprintf(out, ",");
+        }
+      }
+      std::fprintf(out, "\n");
+    }
+  }
+  if (json) {
+    std::fprintf(out, "\n]}\n");
+  }
+}
+
+// 汇总各线程的累计值, 程序退出时输出。Reporter 在静态初始化阶段构造,
+// 析构得最晚: 线程退出时 (主线程在静态对象析构之前) 把自己的累计值并入
+// 这里; Site 都是函数内的静态对象, 析构函数平凡, 退出时仍可读取
+class Reporter {
+private:
+  std::mutex lock;
+  std::vector<Totals> totals; // 按 Site::id 下标
+
+public:
+  void merge(const std::vector<Totals> &thread) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (totals.size() < thread.size()) {
+      totals.resize(thread.size());
+    }
+    for (size_t i = 0; i < thread.size(); i++) {
+      totals[i].add(thread[i]);
+    }
+  }
+
+  ~Reporter() {
+    if (siteList().load() == nullptr) {
+      return;
+    }
+    totals.resize(siteCount().load());
+    const char *path = std::getenv("LAB_INSTRUMENT_OUTPUT");
+    if (path == nullptr || *path == '\0') {
+      writeReport(stderr, false, totals);
+      return;
+    }
+    size_t len = std::strlen(path);
+    bool json = len >= 5 && std::strcmp(path + len - 5, ".json") == 0;
+    FILE *out = std::fopen(path, "w");
+    if (out == nullptr) {
+      std::fprintf(stderr, "无法写入打点结果: %s\n", path);
+      return;
+    }
+    writeReport(out, json, totals);
+    std::fclose(out);
+  }
+};
+
+inline Reporter reporter;
+
+// 当前线程的累计值, 按 Site::id 下标。打点只写本线程的数据, 不用原子操作,
+// 也不与其他线程争用缓存行; 线程退出时一次并入 Reporter
+struct ThreadTotals {
+  std::vector<Totals> sites;
+
+  ~ThreadTotals() { reporter.merge(sites); }
+
+  Totals &at(unsigned id) {
+    if (id >= sites.size()) {
+      sites.resize(id + 1);
+    }
+    return sites[id];
+  }
+};
+
+inline ThreadTotals &threadTotals() {
+  thread_local ThreadTotals totals;
+  return totals;
+}
+
+// 作用域计时器: 构造时记下时间与计数器, 析构时把差值累计到本线程。
+// active 为 false 时什么也不做, 用于只在较大的子问题上打点
+class Scope {
+private:
+  const Site &site;
+  bool active;
+  bool counting = false;
+  uint64_t begin[COUNTERS];
+  std::chrono::steady_clock::time_point start;
+
+public:
+  explicit Scope(const Site &s, bool enabled = true)
+      : site(s), active(enabled) {
+    if (active) {
+      counting = threadPerf().read(begin);
+      start = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~Scope() {
+    if (!active) {
+      return;
+    }
+    auto end = std::chrono::steady_clock::now();
+    Totals &totals = threadTotals().at(site.id);
+    totals.calls++;
+    totals.nanos +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count();
+    uint64_t after[COUNTERS];
+    if (counting && threadPerf().read(after)) {
+      for (int k = 0; k < COUNTERS; k++) {
+        totals.counters[k] += after[k] - begin[k];
+      }
+      totals.available |= threadPerf().mask();
+    }
+  }
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+};
+
+#endif
+
+} // namespace instrument
+
+#define INSTRUMENT_CONCAT2(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT2(a, b)
+
+#define INSTRUMENT_SCOPE(name) INSTRUMENT_SCOPE_IF(name, true)
+
+#ifdef LAB_INSTRUMENT
+#define INSTRUMENT_SCOPE_IF(name, cond)                                       \
+  static instrument::Site INSTRUMENT_CONCAT(instrumentSite, __LINE__)(name);  \
+  instrument::Scope INSTRUMENT_CONCAT(instrumentScope, __LINE__)(              \
+      INSTRUMENT_CONCAT(instrumentSite, __LINE__), (cond))
+#else
+#define INSTRUMENT_SCOPE_IF(name, cond) static_cast<void>(0)
+#endif
+
+#endif // LAB_COMMON_INSTRUMENT_H